@@ -1,35 +1,72 @@
 #include "Problem.h"
 #include <fstream>
 #include <algorithm>
+#include "trace.h"
 
 Problem::Problem(node_idx_t n, node_idx_t L): n{n}, L{L} {
     w = std::vector<std::vector<weight_t>>(n);
-    adj_m = std::vector<std::vector<bool>>(n);
     adj_l = std::vector<std::vector<std::pair<node_idx_t, weight_t>>>(n);
+    bit_words = (n + 63) / 64;
+    out_bits = std::vector<uint64_t>(n * bit_words);
+    in_bits = std::vector<uint64_t>(n * bit_words);
 
     for (node_idx_t i = 0; i < n; ++i) {
         w[i] = std::vector<weight_t>(n);
-        adj_m[i] = std::vector<bool>(n);
     }
 }
 
 Problem Problem::from_config_file(const std::string &filename) {
+    TraceSpan span{"parse"};
     std::ifstream fs{filename};
     node_idx_t n, m, L;
     fs >> n >> m >> L;
-    Problem p{n, L};
 
-    node_idx_t from, to;
-    weight_t weight;
+    std::vector<Arc> arcs(m);
     for (size_t i = 0; i < m; ++i) {
-        fs >> from >> to >> weight;
-        p.adj_m[from][to] = true;
-        p.w[from][to] = weight;
-        p.adj_l[from].emplace_back(to, weight);
+        fs >> arcs[i].from >> arcs[i].to >> arcs[i].w;
+    }
+    return from_arcs(n, L, arcs);
+}
+
+Problem Problem::from_arcs(node_idx_t n, node_idx_t L, const std::vector<Arc> &arcs) {
+    TraceSpan build_span{"build_adjacency"};
+    Problem p{n, L};
+    for (const auto &a: arcs) {
+        p.out_bits[a.from * p.bit_words + a.to / 64] |= uint64_t{1} << (a.to % 64);
+        p.in_bits[a.to * p.bit_words + a.from / 64] |= uint64_t{1} << (a.from % 64);
+        p.w[a.from][a.to] = a.w;
+        p.adj_l[a.from].emplace_back(a.to, a.w);
     }
+    build_span.set_arg("n", n);
+    build_span.set_arg("arcs", static_cast<long long>(arcs.size()));
+
+    TraceSpan sort_span{"sort"};
     for (auto &l: p.adj_l) {
         std::sort(l.begin(), l.end(), [&](const std::pair<node_idx_t, weight_t> &p1, const std::pair<node_idx_t, weight_t> &p2){return p1.second > p2.second;});
     }
+    sort_span.finish();
+
+    p.arc_offset = std::vector<node_idx_t>(n + 1);
+    p.arc_to.reserve(arcs.size());
+    p.arc_w.reserve(arcs.size());
+    for (node_idx_t v = 0; v < n; ++v) {
+        p.arc_offset[v] = static_cast<node_idx_t>(p.arc_to.size());
+        for (const auto &to: p.adj_l[v]) {
+            p.arc_to.push_back(to.first);
+            p.arc_w.push_back(to.second);
+        }
+    }
+    p.arc_offset[n] = static_cast<node_idx_t>(p.arc_to.size());
 
     return p;
 }
+
+std::vector<Arc> Problem::arcs() const {
+    std::vector<Arc> res;
+    for (node_idx_t from = 0; from < n; ++from) {
+        for (const auto &to: adj_l[from]) {
+            res.push_back(Arc{from, to.first, to.second});
+        }
+    }
+    return res;
+}
@@ -2,25 +2,49 @@
 #define COCONTEST_HEURISTICS_PROBLEM_H
 
 #include <vector>
+#include <cstdint>
 #include "common_types.h"
 #include <string>
 
+/*!
+ * Directed weighted arc of the problem graph
+ */
+struct Arc {
+    node_idx_t from;
+    node_idx_t to;
+    weight_t w;
+};
+
 /*!
  * Struct representing the problem instance.
  */
 struct Problem {
     node_idx_t n{}, L{}; // Number of vertices, edges, max loop length
     // Using both adjacency matrix and adjacency list for both fast retrieving of edge value and node neighbours
-    std::vector<std::vector<bool>> adj_m;
     std::vector<std::vector<weight_t>> w;
 
     // Vector of pairs in format <node, weight>
     std::vector<std::vector<std::pair<node_idx_t, weight_t>>> adj_l;
 
+    // Adjacency matrix packed into bitset rows of bit_words 64-bit words. Row u of out_bits has bit v set if there is
+    // an arc u->v, row v of in_bits has bit u set for the same arc
+    size_t bit_words{};
+    std::vector<uint64_t> out_bits;
+    std::vector<uint64_t> in_bits;
+
+    // adj_l flattened into structure of arrays: arcs of node v are arc_to/arc_w[arc_offset[v]..arc_offset[v + 1]),
+    // in the same order as in adj_l[v]
+    std::vector<node_idx_t> arc_offset;
+    std::vector<node_idx_t> arc_to;
+    std::vector<weight_t> arc_w;
+
     // Constructors. Not all are needed but let it be
     Problem() = default;
     Problem(Problem &p) = default;
     Problem(const Problem &p) = default;
+    Problem(Problem &&p) = default;
+    Problem &operator=(const Problem &p) = default;
+    Problem &operator=(Problem &&p) = default;
     Problem(node_idx_t n, node_idx_t L);
 
     /*!
@@ -29,6 +53,32 @@ struct Problem {
      * @return properly initialized Problem instance
      */
     static Problem from_config_file(const std::string &filename);
+
+    /*!
+     * Factory method to create a problem from the list of its arcs
+     * @param n Number of nodes
+     * @param L Max cycle length
+     * @param arcs Arcs of the problem. Nodes are numbered from 0 to n - 1
+     * @return properly initialized Problem instance
+     */
+    static Problem from_arcs(node_idx_t n, node_idx_t L, const std::vector<Arc> &arcs);
+
+    bool has_arc(node_idx_t from, node_idx_t to) const {
+        return (out_bits[from * bit_words + to / 64] >> (to % 64)) & 1u;
+    }
+
+    const uint64_t *out_row(node_idx_t v) const {
+        return &out_bits[v * bit_words];
+    }
+
+    const uint64_t *in_row(node_idx_t v) const {
+        return &in_bits[v * bit_words];
+    }
+
+    /*!
+     * Get all arcs of the problem in the order of adjacency lists
+     */
+    std::vector<Arc> arcs() const;
 };
 
 
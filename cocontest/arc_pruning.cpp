@@ -0,0 +1,111 @@
+#include "arc_pruning.h"
+#include <algorithm>
+#include <thread>
+#include "trace.h"
+
+namespace {
+    // Rows of so few words are not worth starting threads for
+    const size_t MIN_WORDS_PER_THREAD = 1 << 16;
+
+    // Call f(begin, end) on parts of the node range [0, n) in parallel
+    template<typename F>
+    void parallel_for_nodes(node_idx_t n, unsigned threads, F f) {
+        if (threads <= 1) {
+            f(0, n);
+            return;
+        }
+        std::vector<std::thread> workers;
+        const node_idx_t chunk = (n + threads - 1) / threads;
+        for (node_idx_t begin = 0; begin < n; begin += chunk) {
+            workers.emplace_back(f, begin, std::min(n, begin + chunk));
+        }
+        for (auto &w: workers) {
+            w.join();
+        }
+    }
+}
+
+bool prune_unreachable_arcs(Problem &p, std::vector<node_idx_t> &original_id, PruningReport *report,
+                            unsigned threads) {
+    TraceSpan span{"prune_arcs"};
+    const size_t words = p.bit_words;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(1, p.n * words / MIN_WORDS_PER_THREAD)));
+
+    // reach has row v with the nodes reachable from v in at most k steps, starting with k = 0
+    std::vector<uint64_t> reach(p.n * words);
+    for (node_idx_t v = 0; v < p.n; ++v) {
+        reach[v * words + v / 64] |= uint64_t{1} << (v % 64);
+    }
+    std::vector<uint64_t> next(reach.size());
+    for (node_idx_t k = 1; k < p.L; ++k) {
+        parallel_for_nodes(p.n, threads, [&](node_idx_t begin, node_idx_t end) {
+            for (node_idx_t v = begin; v < end; ++v) {
+                uint64_t *row = &next[v * words];
+                std::copy(&reach[v * words], &reach[v * words] + words, row);
+                for (node_idx_t i = p.arc_offset[v]; i < p.arc_offset[v + 1]; ++i) {
+                    const uint64_t *to_row = &reach[p.arc_to[i] * words];
+                    for (size_t j = 0; j < words; ++j) {
+                        row[j] |= to_row[j];
+                    }
+                }
+            }
+        });
+        reach.swap(next);
+    }
+
+    std::vector<Arc> arcs;
+    std::vector<char> has_arc(p.n);
+    for (node_idx_t u = 0; u < p.n; ++u) {
+        for (node_idx_t i = p.arc_offset[u]; i < p.arc_offset[u + 1]; ++i) {
+            const node_idx_t v = p.arc_to[i];
+            if ((reach[v * words + u / 64] >> (u % 64)) & 1u) {
+                arcs.push_back(Arc{u, v, p.arc_w[i]});
+                has_arc[u] = true;
+            }
+        }
+    }
+    reach = std::vector<uint64_t>();
+    next = std::vector<uint64_t>();
+
+    PruningReport r;
+    r.nodes_before = r.nodes_after = p.n;
+    r.arcs_before = r.arcs_after = p.arc_to.size();
+    span.set_arg("arcs_before", static_cast<long long>(r.arcs_before));
+    if (arcs.size() == r.arcs_before) {
+        // Rebuilding the problem would only cost time and memory
+        span.set_arg("arcs_after", static_cast<long long>(r.arcs_after));
+        if (report) {
+            *report = r;
+        }
+        return false;
+    }
+
+    // Every kept arc is on a cycle, so a node with a kept incoming arc has a kept outgoing one as well
+    std::vector<node_idx_t> new_id(p.n, -1);
+    original_id.clear();
+    for (node_idx_t v = 0; v < p.n; ++v) {
+        if (has_arc[v]) {
+            new_id[v] = static_cast<node_idx_t>(original_id.size());
+            original_id.push_back(v);
+        }
+    }
+    for (auto &a: arcs) {
+        a.from = new_id[a.from];
+        a.to = new_id[a.to];
+    }
+    r.nodes_after = static_cast<node_idx_t>(original_id.size());
+    r.arcs_after = arcs.size();
+    span.set_arg("nodes_before", r.nodes_before);
+    span.set_arg("nodes_after", r.nodes_after);
+    span.set_arg("arcs_after", static_cast<long long>(r.arcs_after));
+    if (report) {
+        *report = r;
+    }
+    const node_idx_t L = p.L;
+    p = Problem();
+    p = Problem::from_arcs(r.nodes_after, L, arcs);
+    return true;
+}
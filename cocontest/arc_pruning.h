@@ -0,0 +1,35 @@
+#ifndef COCONTEST_HEURISTICS_ARC_PRUNING_H
+#define COCONTEST_HEURISTICS_ARC_PRUNING_H
+
+#include <vector>
+#include <cstddef>
+#include "common_types.h"
+#include "Problem.h"
+
+/*!
+ * Size of the problem before and after pruning
+ */
+struct PruningReport {
+    node_idx_t nodes_before = 0;
+    node_idx_t nodes_after = 0;
+    size_t arcs_before = 0;
+    size_t arcs_after = 0;
+};
+
+/*!
+ * Remove arcs that can not be on any cycle of length at most L and the nodes left without arcs. An arc u->v is kept
+ * only if u is reachable from v in at most L - 1 steps. Sets of nodes reachable from every node in k steps are computed
+ * as bitset rows for k = 1..L-1, each one from the previous by OR-ing the rows of successors. Rows of different nodes
+ * are independent, so each step is split among threads
+ * @param p Problem to prune. Replaced by the pruned problem, whose nodes are numbered 0..n'-1 in the order of their ids in
+ * the original one. The original is freed before the pruned one is built, so both are never in memory at once
+ * @param original_id Filled with the id in the original problem of each node of the pruned one. Left as it is if
+ * nothing was pruned
+ * @param report If not null, filled with the sizes of both problems
+ * @param threads Number of threads to use. 0 for the number of hardware threads
+ * @return False if no arc was pruned. p is then left untouched
+ */
+bool prune_unreachable_arcs(Problem &p, std::vector<node_idx_t> &original_id, PruningReport *report = nullptr,
+                            unsigned threads = 0);
+
+#endif //COCONTEST_HEURISTICS_ARC_PRUNING_H
@@ -0,0 +1,328 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <cstdlib>
+#include <cstring>
+#include "instance_generator.h"
+#include "Problem.h"
+#include "heuristics.h"
+#include "tabu_search.h"
+#include "search_stats.h"
+#include "node_ordering.h"
+
+/*
+ * Benchmark of the cocontest heuristics on generated instances.
+ *  - Microbenchmarks: mean time of a single call of each heuristic on a solution built by the initial construction
+ *  - Macro runs: full tabu search with a fixed time limit, reporting iterations per second and cost at given times
+ *  - Fixed runs: tabu search stopped after a fixed number of iterations. Its cost depends only on the seed, not on the
+ *    speed of the machine, so it is the one compared to the baseline
+ * Results can be saved as a baseline. When a baseline is given, the benchmark fails if the best iterations per second of
+ * repeated macro runs or the cost of the fixed run drop below the baseline by more than the tolerance. Other load on the
+ * machine only slows runs down, so the best one is the least noisy
+ */
+
+namespace {
+    using solution_t = std::vector<node_idx_t>;
+
+    struct Scenario {
+        std::string name;
+        GeneratorConfig config;
+    };
+
+    struct MacroResult {
+        double iterations_per_s;
+        weight_t fixed_cost; // After Settings::fixed_iterations iterations
+    };
+
+    struct Settings {
+        double macro_time_s = 2;
+        double micro_time_s = 0.2;
+        size_t fixed_iterations = 100;
+        int macro_repeats = 3; // Iterations per second are the best of this many macro runs
+        unsigned seed = 42;
+        bool quick = false;
+        std::string baseline_filename;
+        std::string write_baseline_filename;
+        std::string curve_filename;
+        double iterations_tolerance = 0.2;
+        double cost_tolerance = 0.02;
+        NodeOrdering ordering = NodeOrdering::NONE;
+    };
+
+    // Fractions of the time limit at which the cost is reported
+    const double CURVE_POINTS[] = {0.05, 0.1, 0.25, 0.5, 0.75, 1.0};
+
+    std::vector<Scenario> get_scenarios(const Settings &settings) {
+        std::vector<Scenario> scenarios;
+        auto add = [&](const std::string &name, node_idx_t n, double density, node_idx_t L, WeightDistribution weights) {
+            Scenario s;
+            s.name = name;
+            s.config.n = n;
+            s.config.density = density;
+            s.config.L = L;
+            s.config.weights = weights;
+            s.config.seed = settings.seed;
+            scenarios.push_back(s);
+        };
+        add("small_uniform_L3", 300, 0.03, 3, WeightDistribution::UNIFORM);
+        add("medium_normal_L4", 1000, 0.01, 4, WeightDistribution::NORMAL);
+        if (!settings.quick) {
+            add("medium_exponential_L5", 1000, 0.008, 5, WeightDistribution::EXPONENTIAL);
+            add("large_uniform_L3", 4000, 0.002, 3, WeightDistribution::UNIFORM);
+        }
+        return scenarios;
+    }
+
+    // Call f repeatedly for at least min_time_s and return the mean time of one call in microseconds
+    template<typename F>
+    double mean_call_time_us(F f, double min_time_s) {
+        auto start = std::chrono::steady_clock::now();
+        size_t calls = 0;
+        double elapsed;
+        do {
+            f();
+            ++calls;
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (elapsed < min_time_s);
+        return elapsed * 1e6 / calls;
+    }
+
+    // Build a solution the same way the tabu search builds its initial ones
+    solution_t initial_solution(const Problem &p) {
+        solution_t solution(p.n);
+        while (create_random_cycle(p, solution, false)) {}
+        while (add_to_cycles(p, solution)) {}
+        return solution;
+    }
+
+    void run_microbenchmarks(const Problem &p, const Settings &settings) {
+        const auto base = initial_solution(p);
+        const double t = settings.micro_time_s;
+        std::cout << "  micro (us/call, mutating heuristics include copying the solution):\n";
+        auto flags = std::cout.flags();
+        auto precision = std::cout.precision();
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "    find_cycles          " << mean_call_time_us([&]() { find_cycles(p, base); }, t) << "\n";
+        std::cout << "    get_solution_cost    " << mean_call_time_us([&]() { get_solution_cost(p, base); }, t) << "\n";
+        // The base solution has no free cycle to create, so start from a solution with a broken cycle
+        auto broken = base;
+        break_random_cycle(p, broken);
+        std::cout << "    create_random_cycle  " << mean_call_time_us([&]() {
+            auto s = broken;
+            create_random_cycle(p, s);
+        }, t) << "\n";
+        std::cout << "    add_to_cycles        " << mean_call_time_us([&]() {
+            auto s = base;
+            add_to_cycles(p, s);
+        }, t) << "\n";
+        std::cout << "    shorten_long_cycles  " << mean_call_time_us([&]() {
+            auto s = base;
+            shorten_long_cycles(p, s);
+        }, t) << "\n";
+        std::cout.flags(flags);
+        std::cout.precision(precision);
+    }
+
+    // Best cost found up to time t according to the incumbent trace
+    weight_t cost_at(const std::vector<std::pair<double, weight_t>> &trace, double t) {
+        weight_t cost = 0;
+        for (const auto &point: trace) {
+            if (point.first > t) {
+                break;
+            }
+            cost = point.second;
+        }
+        return cost;
+    }
+
+    // Run the search for the time limit and return its iterations per second
+    double run_macro(const Scenario &scenario, const Problem &p, const Settings &settings, std::ostream *curve) {
+        TabuSearchOptions options;
+        // The benchmark measures the search for the whole time, not the time left after a safety margin
+        options.use_time_margin = false;
+        auto solution = solve_tabu_search(p, solution_t(p.n), static_cast<long long>(settings.macro_time_s * 1e6), options);
+        const auto &stats = search_stats();
+
+        const double iterations_per_s = stats.search_time_s > 0 ? stats.iterations / stats.search_time_s : 0;
+
+        std::cout << "  macro: " << stats.iterations << " iterations, " << iterations_per_s << " it/s, "
+                  << stats.neighbourhood_probes / std::max(stats.search_time_s, 1e-9) << " probes/s, final cost "
+                  << get_solution_cost(p, solution) << "\n";
+        std::cout << "  cost at time:";
+        for (double fraction: CURVE_POINTS) {
+            double t = fraction * settings.macro_time_s;
+            std::cout << " " << t << "s=" << cost_at(stats.incumbent_trace, t);
+        }
+        std::cout << "\n";
+        if (curve) {
+            for (const auto &point: stats.incumbent_trace) {
+                *curve << scenario.name << "," << point.first << "," << point.second << "\n";
+            }
+        }
+        return iterations_per_s;
+    }
+
+    // Cost of the search stopped after settings.fixed_iterations iterations, the same on every run with the same seed
+    weight_t run_fixed(const Problem &p, const Settings &settings) {
+        TabuSearchOptions options;
+        options.use_time_margin = false;
+        options.max_iterations = settings.fixed_iterations;
+        auto solution = solve_tabu_search(p, solution_t(p.n), std::numeric_limits<long long>::max(), options);
+        auto cost = get_solution_cost(p, solution);
+        std::cout << "  fixed: cost " << cost << " after " << settings.fixed_iterations << " iterations\n";
+        return cost;
+    }
+
+    std::map<std::string, MacroResult> read_baseline(const std::string &filename) {
+        std::map<std::string, MacroResult> res;
+        std::ifstream is{filename};
+        std::string line;
+        while (std::getline(is, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            std::stringstream ss{line};
+            std::string name;
+            MacroResult r;
+            if (ss >> name >> r.iterations_per_s >> r.fixed_cost) {
+                res[name] = r;
+            }
+        }
+        return res;
+    }
+
+    void print_usage(const char *program) {
+        std::cerr << "Usage: " << program << " [options]\n"
+                  << "Options:\n"
+                  << "  --quick                   run only the small scenarios with short time limits\n"
+                  << "  --time <s>                time limit of each macro run (default 2)\n"
+                  << "  --seed <seed>             seed of instances and of the search (default 42)\n"
+                  << "  --baseline <file>         fail if results regress compared to this baseline\n"
+                  << "  --write-baseline <file>   save macro results as a baseline\n"
+                  << "  --tolerance <f>           allowed relative drop of iterations per second (default 0.2)\n"
+                  << "  --cost-tolerance <f>      allowed relative drop of the fixed run cost (default 0.02)\n"
+                  << "  --iterations <n>          iterations of the fixed run (default 100, 40 with --quick)\n"
+                  << "  --repeats <n>             macro runs whose best iterations per second is compared (default 3)\n"
+                  << "  --curve-out <file>        write all incumbents as CSV scenario,time_s,cost\n"
+                  << "  --reorder <order>         relabel nodes of the instances: none (default), bfs or rcm" << std::endl;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    Settings settings;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--quick") {
+            settings.quick = true;
+            settings.macro_time_s = 0.5;
+            settings.micro_time_s = 0.05;
+            settings.fixed_iterations = 40;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Unknown argument or missing value: " << arg << std::endl;
+            print_usage(argv[0]);
+            return -1;
+        }
+        const char *value = argv[++i];
+        if (arg == "--time") {
+            settings.macro_time_s = std::atof(value);
+        } else if (arg == "--seed") {
+            settings.seed = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        } else if (arg == "--baseline") {
+            settings.baseline_filename = value;
+        } else if (arg == "--write-baseline") {
+            settings.write_baseline_filename = value;
+        } else if (arg == "--tolerance") {
+            settings.iterations_tolerance = std::atof(value);
+        } else if (arg == "--cost-tolerance") {
+            settings.cost_tolerance = std::atof(value);
+        } else if (arg == "--repeats") {
+            settings.macro_repeats = std::max(1, std::atoi(value));
+        } else if (arg == "--iterations") {
+            settings.fixed_iterations = std::strtoul(value, nullptr, 10);
+        } else if (arg == "--curve-out") {
+            settings.curve_filename = value;
+        } else if (arg == "--reorder") {
+            if (!parse_node_ordering(value, settings.ordering)) {
+                std::cerr << "Unknown node ordering: " << value << std::endl;
+                return -1;
+            }
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            print_usage(argv[0]);
+            return -1;
+        }
+    }
+
+    std::map<std::string, MacroResult> baseline;
+    if (!settings.baseline_filename.empty()) {
+        baseline = read_baseline(settings.baseline_filename);
+    }
+    std::ofstream curve_file;
+    if (!settings.curve_filename.empty()) {
+        curve_file.open(settings.curve_filename);
+        curve_file << "scenario,time_s,cost\n";
+    }
+
+    std::map<std::string, MacroResult> results;
+    bool regressed = false;
+    for (const auto &scenario: get_scenarios(settings)) {
+        auto p = generate_instance(scenario.config);
+        if (settings.ordering != NodeOrdering::NONE) {
+            p = relabel_nodes(p, node_order(p, settings.ordering));
+        }
+        std::cout << scenario.name << " (n = " << p.n << ", arcs = " << p.arcs().size() << ", L = " << p.L
+                  << ", weights = " << weight_distribution_name(scenario.config.weights) << ", node order "
+                  << node_ordering_name(settings.ordering) << ")\n";
+        seed_random_engine(settings.seed);
+        run_microbenchmarks(p, settings);
+        std::vector<double> iterations_per_s;
+        for (int repeat = 0; repeat < settings.macro_repeats; ++repeat) {
+            seed_random_engine(settings.seed);
+            auto curve = curve_file.is_open() && repeat == 0 ? &curve_file : nullptr;
+            iterations_per_s.push_back(run_macro(scenario, p, settings, curve));
+        }
+        MacroResult res;
+        res.iterations_per_s = *std::max_element(iterations_per_s.begin(), iterations_per_s.end());
+        std::cout << "  best: " << res.iterations_per_s << " it/s\n";
+        seed_random_engine(settings.seed);
+        res.fixed_cost = run_fixed(p, settings);
+        results[scenario.name] = res;
+
+        auto b = baseline.find(scenario.name);
+        if (b != baseline.end()) {
+            if (res.iterations_per_s < b->second.iterations_per_s * (1 - settings.iterations_tolerance)) {
+                std::cout << "  REGRESSION: " << res.iterations_per_s << " it/s, baseline "
+                          << b->second.iterations_per_s << "\n";
+                regressed = true;
+            }
+            if (res.fixed_cost < b->second.fixed_cost * (1 - settings.cost_tolerance)) {
+                std::cout << "  REGRESSION: fixed run cost " << res.fixed_cost << ", baseline " << b->second.fixed_cost
+                          << "\n";
+                regressed = true;
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    if (!settings.write_baseline_filename.empty()) {
+        std::ofstream os{settings.write_baseline_filename};
+        os << "# scenario iterations_per_s fixed_run_cost\n";
+        for (const auto &r: results) {
+            os << r.first << " " << r.second.iterations_per_s << " " << r.second.fixed_cost << "\n";
+        }
+    }
+    if (regressed) {
+        std::cout << "Benchmark FAILED: performance regressed compared to " << settings.baseline_filename << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include "instance_generator.h"
+
+namespace {
+    void print_usage(const char *program) {
+        std::cerr << "Usage: " << program << " output_filename [options]\n"
+                  << "Options:\n"
+                  << "  --n <nodes>             number of nodes (default 1000)\n"
+                  << "  --density <d>           expected fraction of other nodes each node has an arc to (default 0.01)\n"
+                  << "  --L <length>            max cycle length (default 3)\n"
+                  << "  --weights <dist>        uniform, normal or exponential (default uniform)\n"
+                  << "  --reciprocity <r>       probability of adding the reverse arc (default 0.3)\n"
+                  << "  --hard-to-match <f>     fraction of nodes with low out-degree (default 0.2)\n"
+                  << "  --seed <seed>           random seed (default 0)" << std::endl;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return -1;
+    }
+    GeneratorConfig config;
+    for (int i = 2; i < argc; ++i) {
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << argv[i] << std::endl;
+            return -1;
+        }
+        std::string arg = argv[i];
+        const char *value = argv[++i];
+        if (arg == "--n") {
+            config.n = std::atoi(value);
+        } else if (arg == "--density") {
+            config.density = std::atof(value);
+        } else if (arg == "--L") {
+            config.L = std::atoi(value);
+        } else if (arg == "--weights") {
+            if (!parse_weight_distribution(value, config.weights)) {
+                std::cerr << "Unknown weight distribution: " << value << std::endl;
+                return -1;
+            }
+        } else if (arg == "--reciprocity") {
+            config.reciprocity = std::atof(value);
+        } else if (arg == "--hard-to-match") {
+            config.hard_to_match = std::atof(value);
+        } else if (arg == "--seed") {
+            config.seed = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            print_usage(argv[0]);
+            return -1;
+        }
+    }
+    if (config.n < 2) {
+        std::cerr << "At least 2 nodes are needed" << std::endl;
+        return -1;
+    }
+    auto p = generate_instance(config);
+    if (!write_instance(p, argv[1])) {
+        std::cerr << "Could not write " << argv[1] << std::endl;
+        return -1;
+    }
+    return 0;
+}
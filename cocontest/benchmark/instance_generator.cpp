@@ -0,0 +1,112 @@
+#include "instance_generator.h"
+#include <random>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+    weight_t random_weight(WeightDistribution distribution, std::mt19937 &rng) {
+        double w;
+        switch (distribution) {
+            case WeightDistribution::NORMAL: {
+                std::normal_distribution<double> dist(50, 15);
+                w = std::min(100.0, std::max(1.0, dist(rng)));
+                break;
+            }
+            case WeightDistribution::EXPONENTIAL: {
+                std::exponential_distribution<double> dist(1.0 / 20);
+                w = 1 + dist(rng);
+                break;
+            }
+            default: {
+                std::uniform_real_distribution<double> dist(1, 100);
+                w = dist(rng);
+                break;
+            }
+        }
+        // Inputs have one decimal place
+        return static_cast<weight_t>(std::round(w * 10) / 10);
+    }
+}
+
+Problem generate_instance(const GeneratorConfig &config) {
+    std::mt19937 rng(config.seed);
+    const node_idx_t n = config.n;
+    std::uniform_real_distribution<double> unit(0, 1);
+    std::uniform_int_distribution<node_idx_t> random_node(0, n - 1);
+
+    // has_arc is used to avoid duplicate arcs
+    std::vector<std::vector<node_idx_t>> successors(n);
+    std::vector<std::vector<bool>> has_arc(n, std::vector<bool>(n, false));
+    auto add_arc = [&](node_idx_t from, node_idx_t to) {
+        if (from == to || has_arc[from][to]) {
+            return;
+        }
+        has_arc[from][to] = true;
+        successors[from].push_back(to);
+    };
+
+    const double mean_degree = std::max(1.0, config.density * (n - 1));
+    for (node_idx_t u = 0; u < n; ++u) {
+        double node_mean_degree = unit(rng) < config.hard_to_match ? std::max(1.0, mean_degree / 10) : mean_degree;
+        std::poisson_distribution<int> degree_dist(node_mean_degree);
+        int degree = std::max(1, std::min(static_cast<int>(n - 1), degree_dist(rng)));
+        for (int k = 0; k < degree; ++k) {
+            node_idx_t v = random_node(rng);
+            add_arc(u, v);
+            if (unit(rng) < config.reciprocity) {
+                add_arc(v, u);
+            }
+        }
+        // In a graph with n > 1 every node must have a successor
+        while (n > 1 && successors[u].empty()) {
+            add_arc(u, random_node(rng));
+        }
+    }
+
+    std::vector<Arc> arcs;
+    for (node_idx_t u = 0; u < n; ++u) {
+        for (auto v: successors[u]) {
+            arcs.push_back(Arc{u, v, random_weight(config.weights, rng)});
+        }
+    }
+    return Problem::from_arcs(n, config.L, arcs);
+}
+
+bool write_instance(const Problem &p, const std::string &filename) {
+    std::ofstream os{filename};
+    if (!os) {
+        return false;
+    }
+    auto arcs = p.arcs();
+    os << p.n << " " << arcs.size() << " " << p.L << "\n";
+    for (const auto &a: arcs) {
+        os << a.from << " " << a.to << " " << a.w << "\n";
+    }
+    return static_cast<bool>(os);
+}
+
+bool parse_weight_distribution(const std::string &name, WeightDistribution &distribution) {
+    if (name == "uniform") {
+        distribution = WeightDistribution::UNIFORM;
+    } else if (name == "normal") {
+        distribution = WeightDistribution::NORMAL;
+    } else if (name == "exponential") {
+        distribution = WeightDistribution::EXPONENTIAL;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char *weight_distribution_name(WeightDistribution distribution) {
+    switch (distribution) {
+        case WeightDistribution::NORMAL:
+            return "normal";
+        case WeightDistribution::EXPONENTIAL:
+            return "exponential";
+        default:
+            return "uniform";
+    }
+}
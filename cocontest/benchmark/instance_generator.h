@@ -0,0 +1,55 @@
+#ifndef COCONTEST_HEURISTICS_INSTANCE_GENERATOR_H
+#define COCONTEST_HEURISTICS_INSTANCE_GENERATOR_H
+
+#include <string>
+#include "Problem.h"
+#include "common_types.h"
+
+/*!
+ * Distribution of arc weights in generated instances
+ */
+enum class WeightDistribution {
+    UNIFORM, // Uniform in [1, 100]
+    NORMAL, // Normal with mean 50 and standard deviation 15, clipped to [1, 100]
+    EXPONENTIAL // 1 + exponential with mean 20. Few very good arcs, many poor ones
+};
+
+/*!
+ * Parameters of a generated compatibility graph
+ */
+struct GeneratorConfig {
+    node_idx_t n = 1000;
+    // Expected fraction of the other nodes each node has an arc to
+    double density = 0.01;
+    node_idx_t L = 3;
+    WeightDistribution weights = WeightDistribution::UNIFORM;
+    // Probability that an arc u->v gets the reverse arc v->u as well. Compatibility graphs have many mutual pairs
+    double reciprocity = 0.3;
+    // Fraction of "hard to match" nodes that get only a tenth of the usual out-degree
+    double hard_to_match = 0.2;
+    unsigned seed = 0;
+};
+
+/*!
+ * Generate a random compatibility graph. Each node gets at least one outgoing arc. The same config always gives the
+ * same instance
+ * @param config Generator parameters
+ * @return Generated problem instance
+ */
+Problem generate_instance(const GeneratorConfig &config);
+
+/*!
+ * Write the problem to a file in the input format of the task
+ * @return True if the file was written successfully
+ */
+bool write_instance(const Problem &p, const std::string &filename);
+
+/*!
+ * Parse the name of weight distribution ("uniform", "normal" or "exponential")
+ * @return True if the name is valid
+ */
+bool parse_weight_distribution(const std::string &name, WeightDistribution &distribution);
+
+const char *weight_distribution_name(WeightDistribution distribution);
+
+#endif //COCONTEST_HEURISTICS_INSTANCE_GENERATOR_H
@@ -2,10 +2,14 @@
 #include <vector>
 #include <stack>
 #include "Problem.h"
+#include "simd_kernels.h"
 #include <algorithm>
 #include <random>
+#include <cstdlib>
 #include <tuple>
 #include <iostream>
+#include <limits>
+#include <cstdint>
 
 using solution_t = std::vector<node_idx_t>;
 
@@ -15,6 +19,11 @@ namespace {
     std::vector<bool> visited;
     std::vector<node_idx_t> cur_permutation;
     std::vector<node_idx_t> cycle_marks;
+    // Cycles already listed by find_cycles, indexed by cycle marks
+    std::vector<bool> listed_cycles;
+    // Bitset buffers for candidate filtering in add_to_cycles
+    std::vector<uint64_t> free_nodes;
+    std::vector<uint64_t> candidates;
 
     // Set edge from node from index "from" to node to index "to" in the solution
     void set_solution_edge(solution_t &solution, const Problem &p, node_idx_t from, node_idx_t to) {
@@ -37,17 +46,20 @@ namespace {
         std::fill(visited.begin(), visited.end(), false);
     }
 
-    // Reshuffle the cur_permutation variable to change the order of nodes traversal
-    void reshuffle_nodes(size_t n) {
+    // Make sure cur_permutation is a permutation of n nodes (it is left from the previous problem otherwise)
+    void ensure_permutation_size(size_t n) {
         if (cur_permutation.size() != n) {
             cur_permutation = std::vector<node_idx_t>(n);
             for (node_idx_t i = 0; i < n; ++i) {
                 cur_permutation[i] = i;
             }
         }
-        static std::random_device dev;
-        static std::mt19937 rng(dev());
-        std::shuffle(cur_permutation.begin(), cur_permutation.end(), rng);
+    }
+
+    // Reshuffle the cur_permutation variable to change the order of nodes traversal
+    void reshuffle_nodes(size_t n) {
+        ensure_permutation_size(n);
+        std::shuffle(cur_permutation.begin(), cur_permutation.end(), random_engine());
     }
 
 
@@ -57,8 +69,9 @@ namespace {
      *   - N, where N is an integer representing a cycle number. Two nodes in the same cycle will have it the same
      * @param p Problem
      * @param solution solution, marking for which should be produced
+     * @return Number that is larger than all the marks
      */
-    void mark_cycles(const Problem &p, const solution_t &solution) {
+    node_idx_t mark_cycles(const Problem &p, const solution_t &solution) {
         cycle_marks = std::vector<node_idx_t>(p.n);
         node_idx_t cur_cycle_idx = 1;
         zero_visited(p.n);
@@ -119,16 +132,31 @@ namespace {
                 }
             }
         }
+        return cur_cycle_idx + 1;
     }
 }
 
+std::mt19937 &random_engine() {
+    static std::random_device dev;
+    static std::mt19937 rng(dev());
+    return rng;
+}
+
+void seed_random_engine(unsigned seed) {
+    random_engine().seed(seed);
+    std::srand(seed);
+    // The traversal order is shuffled in place, so it would carry over the randomness of the previous runs
+    cur_permutation.clear();
+}
+
 std::vector<std::vector<node_idx_t>> find_cycles(const Problem &p, const solution_t &solution) {
-    mark_cycles(p, solution);
-    zero_visited(p.n);
+    ensure_permutation_size(p.n);
+    // Cycle marks go up to n + 1, so they can not index a buffer of n nodes
+    listed_cycles.assign(mark_cycles(p, solution), false);
     std::vector<std::vector<node_idx_t>> res;
     for (node_idx_t i: cur_permutation) {
-        if (cycle_marks[i] != 0 && !visited[cycle_marks[i]]) {
-            visited[cycle_marks[i]] = true;
+        if (cycle_marks[i] != 0 && !listed_cycles[cycle_marks[i]]) {
+            listed_cycles[cycle_marks[i]] = true;
             res.emplace_back();
             size_t current_cycle_idx = res.size() - 1;
             res[current_cycle_idx].emplace_back(i);
@@ -151,9 +179,7 @@ namespace {
         for (node_idx_t i = 0; i < n; ++i) {
             nodes_order[i] = i;
         }
-        static std::random_device dev;
-        static std::mt19937 rng(dev());
-        std::shuffle(nodes_order.begin(), nodes_order.begin() + n, rng);
+        std::shuffle(nodes_order.begin(), nodes_order.begin() + n, random_engine());
         return nodes_order;
     }
 
@@ -241,7 +267,7 @@ bool shorten_long_cycles(const Problem &p, solution_t &cur_solution) {
                 // Try to break the cycle and glue it back into two cycles
                 auto i_next = cycle[(i + 1) % s];
                 auto j_next = cycle[(j + 1) % s];
-                if (p.adj_m[c_j][i_next] && p.adj_m[c_i][j_next]) {
+                if (p.has_arc(c_j, i_next) && p.has_arc(c_i, j_next)) {
                     auto score = p.w[c_j][i_next] + p.w[c_i][j_next] - p.w[c_i][i_next] - p.w[c_j][j_next];
                     if (score > best_break_score) {
                         best_break_score = score;
@@ -260,17 +286,18 @@ bool shorten_long_cycles(const Problem &p, solution_t &cur_solution) {
 }
 
 bool add_to_cycles(const Problem &p, solution_t &cur_solution, bool constrain_cycle_length) {
-    // Get the list of nodes not belonging to any cycle in a random order
-    zero_visited(p.n);
     reshuffle_nodes(p.n);
     const auto cycles = find_cycles(p, cur_solution);
-    std::vector<node_idx_t> not_in_cycles;
+    const auto &kernels = simd_kernels();
+
+    // Bitset of nodes not belonging to any cycle and not inserted into one yet
+    free_nodes.assign(p.bit_words, 0);
     for (node_idx_t i = 0; i < p.n; ++i) {
-        auto idx = cur_permutation[i];
-        if (cycle_marks[idx] == 0) {
-            not_in_cycles.emplace_back(idx);
+        if (cycle_marks[i] == 0) {
+            free_nodes[i / 64] |= uint64_t{1} << (i % 64);
         }
     }
+    candidates.resize(p.bit_words);
     bool inserted = false;
 
     // Loop through each cycle and try to find the best node that can be inserted into that loop
@@ -286,19 +313,27 @@ bool add_to_cycles(const Problem &p, solution_t &cur_solution, bool constrain_cy
             const auto &c_i = cycle[i];
             const auto &c_next = cycle[(i + 1) % s];
 
-            for (const auto &n_i: not_in_cycles) {
-                if (visited[n_i]) continue;
-                if (p.adj_m[c_i][n_i] && p.adj_m[n_i][c_next]) {
-                    auto score = p.w[c_i][n_i] + p.w[n_i][c_next] - p.w[c_i][c_next];
+            // Candidates are free nodes n_i with arcs c_i->n_i and n_i->c_next
+            if (kernels.and3_rows(p.out_row(c_i), p.in_row(c_next), free_nodes.data(), candidates.data(),
+                                  p.bit_words) == 0) {
+                continue;
+            }
+            const auto &w_i = p.w[c_i];
+            const auto removed = p.w[c_i][c_next];
+            for (size_t word = 0; word < p.bit_words; ++word) {
+                for (uint64_t bits = candidates[word]; bits != 0; bits &= bits - 1) {
+                    auto n_i = static_cast<node_idx_t>(word * 64 + __builtin_ctzll(bits));
+                    auto score = w_i[n_i] + p.w[n_i][c_next] - removed;
                     if (score > best_insertion_score) {
                         best_insertion_score = score;
-                        best_insertion = {c_i, n_i, c_next};
+                        best_insertion = std::make_tuple(c_i, n_i, c_next);
                     }
                 }
             }
         }
         if (best_insertion_score != std::numeric_limits<weight_t>::lowest()) {
-            visited[std::get<1>(best_insertion)] = true;
+            auto n_i = std::get<1>(best_insertion);
+            free_nodes[n_i / 64] &= ~(uint64_t{1} << (n_i % 64));
             set_solution_edge(cur_solution, p, std::get<0>(best_insertion), std::get<1>(best_insertion));
             set_solution_edge(cur_solution, p, std::get<1>(best_insertion), std::get<2>(best_insertion));
             inserted = true;
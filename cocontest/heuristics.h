@@ -2,9 +2,21 @@
 #define COCONTEST_HEURISTICS_HEURISTICS_H
 
 #include <vector>
+#include <random>
 #include "common_types.h"
 #include "Problem.h"
 
+/*!
+ * Random engine shared by all the heuristics and the tabu search. Seeded from std::random_device unless
+ * seed_random_engine is called
+ */
+std::mt19937 &random_engine();
+
+/*!
+ * Seed the shared random engine (and std::rand) to make runs reproducible
+ */
+void seed_random_engine(unsigned seed);
+
 /*!
  * Find all cycles in the solution
  * NOTE: cycles in solution are unique and disjoint. There are not two ways to find two different sets of disjoint cycles when one does not fully contain another
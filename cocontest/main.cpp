@@ -4,40 +4,198 @@
 #include "tabu_search.h"
 #include <map>
 #include "heuristics.h"
+#include "search_stats.h"
+#include "trace.h"
+#include "node_ordering.h"
+#include "matching.h"
+#include "arc_pruning.h"
 #include <fstream>
+#include <algorithm>
+#include <sstream>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
 
-void
-write_solution_to_file(const std::string &output_filename, const Problem &p, const std::vector<node_idx_t> &solution) {
-    auto cost = get_solution_cost(p, solution);
-    std::ofstream os{output_filename};
-    os << cost << std::endl;
-    std::cout << "Cost: " << cost << std::endl;
+/*!
+ * Write the solution to the file. The solution is written into a temporary file first that is then renamed to
+ * output_filename, so the output file always contains a complete solution even if the process is killed during writing
+ * @param original_id Original id of each node if the problem was relabeled (see node_ordering.h), empty otherwise
+ * @return Cost of the written solution. It is summed over the written arcs, so it always matches them
+ */
+weight_t
+write_solution_to_file(const std::string &output_filename, const Problem &p, const std::vector<node_idx_t> &solution,
+                       const std::vector<node_idx_t> &original_id) {
+    TraceSpan span{"write_solution"};
+    weight_t cost = 0;
+    std::ostringstream arcs;
     auto cycles = find_cycles(p, solution);
     for (const auto &c: cycles) {
         if (c.size() > p.L) {
             continue;
         }
         auto s = c.size();
+        auto id = [&](node_idx_t v) { return original_id.empty() ? v : original_id[v]; };
 
         for (size_t i = 0; i < s; ++i) {
-          os << c[i] << " " << c[(i + 1) % s] << "\n";
+            cost += p.w[c[i]][c[(i + 1) % s]];
+            arcs << id(c[i]) << " " << id(c[(i + 1) % s]) << "\n";
         }
     }
-    return;
+    const std::string tmp_filename = output_filename + ".tmp";
+    {
+        std::ofstream os{tmp_filename};
+        os << cost << std::endl;
+        os << arcs.str();
+    }
+    if (std::rename(tmp_filename.c_str(), output_filename.c_str()) != 0) {
+        std::cerr << "Could not move " << tmp_filename << " to " << output_filename << std::endl;
+    }
+    return cost;
+}
+
+namespace {
+    void handle_stop_signal(int) {
+        request_tabu_search_stop();
+    }
+
+    void print_usage(const char *program) {
+        std::cerr << "Usage: " << program << " input_filename output_filename time_limit_s [options]\n"
+                  << "Options:\n"
+                  << "  --anytime          write every new best solution to the output file and use the whole time limit\n"
+                  << "  --progress <file>  append \"<elapsed seconds> <cost>\" for every new best solution ('-' for stdout)\n"
+                  << "  --stats <file>     collect per-operator statistics and write them as JSON at exit\n"
+                  << "  --trace <file>     write a Chrome trace (chrome://tracing, Perfetto) of the solver phases at exit\n"
+                  << "  --reorder <order>  relabel nodes for memory locality: none (default), bfs or rcm\n"
+                  << "  --no-prune         keep arcs that can not be on any cycle of length at most L"
+                  << std::endl;
+    }
 }
 
 
 int main(int argc, char *argv[]) {
     if (argc < 4) {
-        std::cerr << "Too few arguments. At least two are needed: input_filename and output_filename " << std::endl;
+        std::cerr << "Too few arguments. At least three are needed: input_filename, output_filename and time_limit" << std::endl;
+        print_usage(argv[0]);
         return -1;
     }
+    bool anytime = false;
+    std::string progress_filename;
+    std::string stats_filename;
+    std::string trace_filename;
+    NodeOrdering ordering = NodeOrdering::NONE;
+    bool prune = true;
+    for (int i = 4; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--anytime") == 0) {
+            anytime = true;
+        } else if (std::strcmp(argv[i], "--progress") == 0 && i + 1 < argc) {
+            progress_filename = argv[++i];
+        } else if (std::strcmp(argv[i], "--stats") == 0 && i + 1 < argc) {
+            stats_filename = argv[++i];
+        } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_filename = argv[++i];
+        } else if (std::strcmp(argv[i], "--no-prune") == 0) {
+            prune = false;
+        } else if (std::strcmp(argv[i], "--reorder") == 0 && i + 1 < argc) {
+            if (!parse_node_ordering(argv[++i], ordering)) {
+                std::cerr << "Unknown node ordering: " << argv[i] << std::endl;
+                print_usage(argv[0]);
+                return -1;
+            }
+        } else {
+            std::cerr << "Unknown argument: " << argv[i] << std::endl;
+            print_usage(argv[0]);
+            return -1;
+        }
+    }
+    auto start_time = std::chrono::steady_clock::now();
+    if (!trace_filename.empty()) {
+        Tracer::instance().enable();
+    }
+
+    // On SIGTERM/SIGINT stop the search and write the best solution found so far
+    std::signal(SIGTERM, handle_stop_signal);
+    std::signal(SIGINT, handle_stop_signal);
+
     Problem p = Problem::from_config_file(argv[1]);
+    // Solutions are found for the pruned and relabeled problem and mapped back to the input ids only when written
+    std::vector<node_idx_t> original_id;
+    // With L = 2 the matching looks only at mutual arcs anyway, so pruning would find nothing it could use
+    bool pruned = false;
+    if (prune && p.L > 2) {
+        PruningReport report;
+        pruned = prune_unreachable_arcs(p, original_id, &report);
+        std::cerr << "Pruned " << report.arcs_before - report.arcs_after << " of " << report.arcs_before << " arcs and "
+                  << report.nodes_before - report.nodes_after << " of " << report.nodes_before << " nodes" << std::endl;
+    }
+    if (ordering != NodeOrdering::NONE) {
+        auto order = node_order(p, ordering);
+        p = relabel_nodes(p, order);
+        if (pruned) {
+            for (auto &v: order) {
+                v = original_id[v];
+            }
+        }
+        original_id = order;
+    }
 #ifdef DEBUG
     std::cout << "Read a problem with n = " << p.n << ", L = " << p.L << std::endl;
 #endif
+    const std::string output_filename = argv[2];
     double time_limit = std::atof(argv[3]);
+
+    std::ofstream progress_file;
+    std::ostream *progress = nullptr;
+    if (progress_filename == "-") {
+        progress = &std::cout;
+    } else if (!progress_filename.empty()) {
+        progress_file.open(progress_filename);
+        progress = &progress_file;
+    }
+
+    search_stats().enabled = !stats_filename.empty();
+
+    TabuSearchOptions options;
+    options.use_time_margin = !anytime;
+    if (anytime || progress) {
+        options.on_new_best = [&](const std::vector<node_idx_t> &solution, weight_t cost) {
+            if (anytime) {
+                write_solution_to_file(output_filename, p, solution, original_id);
+            }
+            if (progress) {
+                auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+                *progress << elapsed << " " << cost << std::endl;
+            }
+        };
+    }
+
+    // The deadline is counted from the program start, so reading, pruning and relabeling the input use it up as well
+    auto max_time_us = static_cast<long long>(time_limit * 1000000);
+    max_time_us = std::max(0ll, max_time_us - std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start_time).count());
     std::vector<node_idx_t> solution(p.n);
-    solution = solve_tabu_search(p, solution, static_cast<long long>(time_limit * 1000000));
-    write_solution_to_file(argv[2], p, solution);
-}
\ No newline at end of file
+    if (p.n == 0) {
+        // Nothing is left after pruning, the empty solution is the only one
+    } else if (p.L == 2) {
+        // Every valid cycle is a mutual pair then, so the maximum weight matching is optimal and no search is needed.
+        // The exact matching may take long on large inputs, so the greedy one is written right away in any case
+        solution = solve_pair_matching(p, max_time_us, [&](const std::vector<node_idx_t> &s, weight_t cost) {
+            if (!anytime) {
+                write_solution_to_file(output_filename, p, s, original_id);
+            }
+            if (options.on_new_best) {
+                options.on_new_best(s, cost);
+            }
+        });
+    } else {
+        solution = solve_tabu_search(p, solution, max_time_us, options);
+    }
+    auto cost = write_solution_to_file(output_filename, p, solution, original_id);
+    std::cout << "Cost: " << cost << std::endl;
+    if (search_stats().enabled && !write_search_stats_json(search_stats(), stats_filename)) {
+        std::cerr << "Could not write statistics to " << stats_filename << std::endl;
+    }
+    if (!trace_filename.empty() && !Tracer::instance().write_chrome_json(trace_filename)) {
+        std::cerr << "Could not write trace to " << trace_filename << std::endl;
+    }
+}
@@ -0,0 +1,692 @@
+#include "matching.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include "tabu_search.h"
+#include "trace.h"
+
+namespace {
+    // Input weights are rounded to a thousandth for the matching
+    const double WEIGHT_SCALE = 1000;
+
+    // Labels of top level blossoms. SCANNED marks blossoms on the path in scan_blossom
+    const int FREE = 0, S_LABEL = 1, T_LABEL = 2, SCANNED = 5;
+
+    /*
+     * Edmonds' blossom algorithm with dual variables. Vertices are 0..n-1, blossoms n..2n-1. An edge k has endpoints
+     * 2k and 2k+1, endpoint p belongs to vertex endpoint[p] and the opposite endpoint is p ^ 1. Matched vertices store
+     * the remote endpoint of the matched edge in mate. Each stage grows alternating trees from all free S-vertices
+     * along tight edges, shrinks odd cycles of S-vertices to blossoms and augments once two trees meet. If no tight
+     * edge is left, the duals change by the largest step keeping them feasible (the four delta types). The stage
+     * ends when a free vertex has a zero dual, as the matching is then optimal. Augmentations keep mate a valid
+     * matching, so the search can stop between any two dual changes
+     */
+    class BlossomMatching {
+    public:
+        BlossomMatching(node_idx_t n, const std::vector<std::pair<node_idx_t, node_idx_t>> &edges,
+                        const std::vector<long long> &weights, const std::chrono::steady_clock::time_point *deadline)
+                : n{n}, weights{weights}, deadline{deadline}, endpoint(2 * edges.size()), neighbend(n), mate(n, -1),
+                  label(2 * n), labelend(2 * n, -1), inblossom(n), blossomparent(2 * n, -1), blossomchilds(2 * n),
+                  blossombase(2 * n, -1), blossomendps(2 * n), bestedge(2 * n, -1), blossombestedges(2 * n),
+                  has_bestedges(2 * n), dualvar(2 * n), allowedge(edges.size()) {
+            long long max_weight = 0;
+            for (size_t k = 0; k < edges.size(); ++k) {
+                endpoint[2 * k] = edges[k].first;
+                endpoint[2 * k + 1] = edges[k].second;
+                neighbend[edges[k].first].push_back(static_cast<int>(2 * k + 1));
+                neighbend[edges[k].second].push_back(static_cast<int>(2 * k));
+                max_weight = std::max(max_weight, weights[k]);
+            }
+            for (node_idx_t v = 0; v < n; ++v) {
+                inblossom[v] = v;
+                blossombase[v] = v;
+                dualvar[v] = max_weight;
+            }
+            for (node_idx_t b = 2 * n - 1; b >= n; --b) {
+                unusedblossoms.push_back(b);
+            }
+        }
+
+        std::vector<node_idx_t> solve() {
+            for (node_idx_t stage = 0; stage < n; ++stage) {
+                if (!run_stage()) {
+                    break;
+                }
+            }
+            std::vector<node_idx_t> res(n, -1);
+            for (node_idx_t v = 0; v < n; ++v) {
+                if (mate[v] >= 0) {
+                    res[v] = endpoint[mate[v]];
+                }
+            }
+            return res;
+        }
+
+        //! False if the time limit or a stop request ended the search before the matching was optimal
+        bool finished() const {
+            return !stopped;
+        }
+
+    private:
+        const node_idx_t n;
+        const std::vector<long long> &weights;
+        const std::chrono::steady_clock::time_point *deadline;
+        bool stopped = false;
+        std::vector<node_idx_t> endpoint;
+        std::vector<std::vector<int>> neighbend;
+        std::vector<int> mate;
+        std::vector<int> label;
+        std::vector<int> labelend;
+        std::vector<node_idx_t> inblossom;
+        std::vector<node_idx_t> blossomparent;
+        std::vector<std::vector<node_idx_t>> blossomchilds;
+        std::vector<node_idx_t> blossombase;
+        std::vector<std::vector<int>> blossomendps;
+        std::vector<int> bestedge;
+        std::vector<std::vector<int>> blossombestedges;
+        std::vector<char> has_bestedges;
+        std::vector<node_idx_t> unusedblossoms;
+        std::vector<long long> dualvar;
+        std::vector<char> allowedge;
+        std::vector<node_idx_t> queue;
+
+        bool out_of_time() {
+            if (is_tabu_search_stop_requested() || (deadline && std::chrono::steady_clock::now() >= *deadline)) {
+                stopped = true;
+            }
+            return stopped;
+        }
+
+        long long slack(int k) const {
+            return dualvar[endpoint[2 * k]] + dualvar[endpoint[2 * k + 1]] - 2 * weights[k];
+        }
+
+        void blossom_leaves(node_idx_t b, std::vector<node_idx_t> &leaves) const {
+            if (b < n) {
+                leaves.push_back(b);
+                return;
+            }
+            for (node_idx_t t: blossomchilds[b]) {
+                blossom_leaves(t, leaves);
+            }
+        }
+
+        std::vector<node_idx_t> blossom_leaves(node_idx_t b) const {
+            std::vector<node_idx_t> leaves;
+            blossom_leaves(b, leaves);
+            return leaves;
+        }
+
+        // Label w and its top level blossom with t, reached through endpoint p. T-blossoms label their mates S
+        void assign_label(node_idx_t w, int t, int p) {
+            while (true) {
+                const node_idx_t b = inblossom[w];
+                label[w] = label[b] = t;
+                labelend[w] = labelend[b] = p;
+                bestedge[w] = bestedge[b] = -1;
+                if (t == S_LABEL) {
+                    blossom_leaves(b, queue);
+                    return;
+                }
+                const int base_mate = mate[blossombase[b]];
+                w = endpoint[base_mate];
+                t = S_LABEL;
+                p = base_mate ^ 1;
+            }
+        }
+
+        // Trace back from S-vertices v and w to find a new blossom (its base is returned) or an augmenting path (-1)
+        node_idx_t scan_blossom(node_idx_t v, node_idx_t w) {
+            std::vector<node_idx_t> path;
+            node_idx_t base = -1;
+            while (v != -1 || w != -1) {
+                node_idx_t b = inblossom[v];
+                if (label[b] & 4) {
+                    base = blossombase[b];
+                    break;
+                }
+                path.push_back(b);
+                label[b] = SCANNED;
+                if (labelend[b] == -1) {
+                    v = -1;
+                } else {
+                    v = endpoint[labelend[b]];
+                    b = inblossom[v];
+                    v = endpoint[labelend[b]];
+                }
+                if (w != -1) {
+                    std::swap(v, w);
+                }
+            }
+            for (node_idx_t b: path) {
+                label[b] = S_LABEL;
+            }
+            return base;
+        }
+
+        // Shrink the cycle closed by edge k through the S-blossoms up to base into a new S-blossom
+        void add_blossom(node_idx_t base, int k) {
+            node_idx_t v = endpoint[2 * k];
+            node_idx_t w = endpoint[2 * k + 1];
+            const node_idx_t bb = inblossom[base];
+            node_idx_t bv = inblossom[v];
+            node_idx_t bw = inblossom[w];
+            const node_idx_t b = unusedblossoms.back();
+            unusedblossoms.pop_back();
+            blossombase[b] = base;
+            blossomparent[b] = -1;
+            blossomparent[bb] = b;
+            auto &path = blossomchilds[b];
+            auto &endps = blossomendps[b];
+            path.clear();
+            endps.clear();
+            while (bv != bb) {
+                blossomparent[bv] = b;
+                path.push_back(bv);
+                endps.push_back(labelend[bv]);
+                v = endpoint[labelend[bv]];
+                bv = inblossom[v];
+            }
+            path.push_back(bb);
+            std::reverse(path.begin(), path.end());
+            std::reverse(endps.begin(), endps.end());
+            endps.push_back(2 * k);
+            while (bw != bb) {
+                blossomparent[bw] = b;
+                path.push_back(bw);
+                endps.push_back(labelend[bw] ^ 1);
+                w = endpoint[labelend[bw]];
+                bw = inblossom[w];
+            }
+            label[b] = S_LABEL;
+            labelend[b] = labelend[bb];
+            dualvar[b] = 0;
+            for (node_idx_t leaf: blossom_leaves(b)) {
+                if (label[inblossom[leaf]] == T_LABEL) {
+                    queue.push_back(leaf);
+                }
+                inblossom[leaf] = b;
+            }
+
+            // Keep the least slack edge to each neighbouring S-blossom
+            std::vector<int> bestedgeto(2 * n, -1);
+            auto consider = [&](int edge) {
+                node_idx_t j = endpoint[2 * edge + 1];
+                if (inblossom[j] == b) {
+                    j = endpoint[2 * edge];
+                }
+                const node_idx_t bj = inblossom[j];
+                if (bj != b && label[bj] == S_LABEL &&
+                    (bestedgeto[bj] == -1 || slack(edge) < slack(bestedgeto[bj]))) {
+                    bestedgeto[bj] = edge;
+                }
+            };
+            for (node_idx_t child: path) {
+                if (has_bestedges[child]) {
+                    for (int edge: blossombestedges[child]) {
+                        consider(edge);
+                    }
+                } else {
+                    for (node_idx_t leaf: blossom_leaves(child)) {
+                        for (int p: neighbend[leaf]) {
+                            consider(p / 2);
+                        }
+                    }
+                }
+                blossombestedges[child].clear();
+                has_bestedges[child] = false;
+                bestedge[child] = -1;
+            }
+            blossombestedges[b].clear();
+            for (int edge: bestedgeto) {
+                if (edge != -1) {
+                    blossombestedges[b].push_back(edge);
+                }
+            }
+            has_bestedges[b] = true;
+            bestedge[b] = -1;
+            for (int edge: blossombestedges[b]) {
+                if (bestedge[b] == -1 || slack(edge) < slack(bestedge[b])) {
+                    bestedge[b] = edge;
+                }
+            }
+        }
+
+        // Position of child t in blossom b, the direction to walk to the base along an even path and the endpoint trick
+        void even_path_direction(node_idx_t b, int &j, int &jstep, int &endptrick) const {
+            if (j & 1) {
+                j -= static_cast<int>(blossomchilds[b].size());
+                jstep = 1;
+                endptrick = 0;
+            } else {
+                jstep = -1;
+                endptrick = 1;
+            }
+        }
+
+        node_idx_t child_at(node_idx_t b, int j) const {
+            const int size = static_cast<int>(blossomchilds[b].size());
+            return blossomchilds[b][(j % size + size) % size];
+        }
+
+        int endp_at(node_idx_t b, int j) const {
+            const int size = static_cast<int>(blossomendps[b].size());
+            return blossomendps[b][(j % size + size) % size];
+        }
+
+        // Replace the top level blossom b by its children. Outside the end of a stage, relabel the children of a T-blossom
+        void expand_blossom(node_idx_t b, bool endstage) {
+            for (node_idx_t s: blossomchilds[b]) {
+                blossomparent[s] = -1;
+                if (s < n) {
+                    inblossom[s] = s;
+                } else if (endstage && dualvar[s] == 0) {
+                    expand_blossom(s, endstage);
+                } else {
+                    for (node_idx_t leaf: blossom_leaves(s)) {
+                        inblossom[leaf] = s;
+                    }
+                }
+            }
+            if (!endstage && label[b] == T_LABEL) {
+                const node_idx_t entrychild = inblossom[endpoint[labelend[b] ^ 1]];
+                int j = static_cast<int>(std::find(blossomchilds[b].begin(), blossomchilds[b].end(), entrychild) -
+                                         blossomchilds[b].begin());
+                int jstep, endptrick;
+                even_path_direction(b, j, jstep, endptrick);
+                int p = labelend[b];
+                while (j != 0) {
+                    label[endpoint[p ^ 1]] = FREE;
+                    label[endpoint[endp_at(b, j - endptrick) ^ endptrick ^ 1]] = FREE;
+                    assign_label(endpoint[p ^ 1], T_LABEL, p);
+                    allowedge[endp_at(b, j - endptrick) / 2] = true;
+                    j += jstep;
+                    p = endp_at(b, j - endptrick) ^ endptrick;
+                    allowedge[p / 2] = true;
+                    j += jstep;
+                }
+                node_idx_t bv = child_at(b, j);
+                label[endpoint[p ^ 1]] = label[bv] = T_LABEL;
+                labelend[endpoint[p ^ 1]] = labelend[bv] = p;
+                bestedge[bv] = -1;
+                j += jstep;
+                while (child_at(b, j) != entrychild) {
+                    bv = child_at(b, j);
+                    if (label[bv] == S_LABEL) {
+                        j += jstep;
+                        continue;
+                    }
+                    for (node_idx_t v: blossom_leaves(bv)) {
+                        if (label[v] != FREE) {
+                            label[v] = FREE;
+                            label[endpoint[mate[blossombase[bv]]]] = FREE;
+                            assign_label(v, T_LABEL, labelend[v]);
+                            break;
+                        }
+                    }
+                    j += jstep;
+                }
+            }
+            label[b] = labelend[b] = -1;
+            blossomchilds[b].clear();
+            blossomendps[b].clear();
+            blossombase[b] = -1;
+            blossombestedges[b].clear();
+            has_bestedges[b] = false;
+            bestedge[b] = -1;
+            unusedblossoms.push_back(b);
+        }
+
+        // Swap matched and unmatched edges on the even path from vertex v to the base of blossom b, making v the base
+        void augment_blossom(node_idx_t b, node_idx_t v) {
+            node_idx_t t = v;
+            while (blossomparent[t] != b) {
+                t = blossomparent[t];
+            }
+            if (t >= n) {
+                augment_blossom(t, v);
+            }
+            const int i = static_cast<int>(std::find(blossomchilds[b].begin(), blossomchilds[b].end(), t) -
+                                           blossomchilds[b].begin());
+            int j = i, jstep, endptrick;
+            even_path_direction(b, j, jstep, endptrick);
+            while (j != 0) {
+                j += jstep;
+                t = child_at(b, j);
+                const int p = endp_at(b, j - endptrick) ^ endptrick;
+                if (t >= n) {
+                    augment_blossom(t, endpoint[p]);
+                }
+                j += jstep;
+                t = child_at(b, j);
+                if (t >= n) {
+                    augment_blossom(t, endpoint[p ^ 1]);
+                }
+                mate[endpoint[p]] = p ^ 1;
+                mate[endpoint[p ^ 1]] = p;
+            }
+            std::rotate(blossomchilds[b].begin(), blossomchilds[b].begin() + i, blossomchilds[b].end());
+            std::rotate(blossomendps[b].begin(), blossomendps[b].begin() + i, blossomendps[b].end());
+            blossombase[b] = blossombase[blossomchilds[b][0]];
+        }
+
+        // Augment the matching along the path through edge k between two S-vertices to the roots of their trees
+        void augment_matching(int k) {
+            const std::pair<node_idx_t, int> sides[] = {{endpoint[2 * k],     2 * k + 1},
+                                                        {endpoint[2 * k + 1], 2 * k}};
+            for (const auto &side: sides) {
+                node_idx_t s = side.first;
+                int p = side.second;
+                while (true) {
+                    const node_idx_t bs = inblossom[s];
+                    if (bs >= n) {
+                        augment_blossom(bs, s);
+                    }
+                    mate[s] = p;
+                    if (labelend[bs] == -1) {
+                        break;
+                    }
+                    const node_idx_t t = endpoint[labelend[bs]];
+                    const node_idx_t bt = inblossom[t];
+                    s = endpoint[labelend[bt]];
+                    const node_idx_t j = endpoint[labelend[bt] ^ 1];
+                    if (bt >= n) {
+                        augment_blossom(bt, j);
+                    }
+                    mate[j] = labelend[bt];
+                    p = labelend[bt] ^ 1;
+                }
+            }
+        }
+
+        // Look for an augmenting path from the current matching. Returns false if the matching is already optimal or the
+        // search has to stop
+        bool run_stage() {
+            std::fill(label.begin(), label.end(), FREE);
+            std::fill(bestedge.begin(), bestedge.end(), -1);
+            for (node_idx_t b = n; b < 2 * n; ++b) {
+                blossombestedges[b].clear();
+                has_bestedges[b] = false;
+            }
+            std::fill(allowedge.begin(), allowedge.end(), false);
+            queue.clear();
+            for (node_idx_t v = 0; v < n; ++v) {
+                if (mate[v] == -1 && label[inblossom[v]] == FREE) {
+                    assign_label(v, S_LABEL, -1);
+                }
+            }
+
+            bool augmented = false;
+            while (true) {
+                if (out_of_time()) {
+                    return false;
+                }
+                while (!queue.empty() && !augmented) {
+                    const node_idx_t v = queue.back();
+                    queue.pop_back();
+                    for (int p: neighbend[v]) {
+                        const int k = p / 2;
+                        const node_idx_t w = endpoint[p];
+                        if (inblossom[v] == inblossom[w]) {
+                            continue;
+                        }
+                        long long kslack = 0;
+                        if (!allowedge[k]) {
+                            kslack = slack(k);
+                            if (kslack <= 0) {
+                                allowedge[k] = true;
+                            }
+                        }
+                        if (allowedge[k]) {
+                            if (label[inblossom[w]] == FREE) {
+                                assign_label(w, T_LABEL, p ^ 1);
+                            } else if (label[inblossom[w]] == S_LABEL) {
+                                const node_idx_t base = scan_blossom(v, w);
+                                if (base >= 0) {
+                                    add_blossom(base, k);
+                                } else {
+                                    augment_matching(k);
+                                    augmented = true;
+                                    break;
+                                }
+                            } else if (label[w] == FREE) {
+                                label[w] = T_LABEL;
+                                labelend[w] = p ^ 1;
+                            }
+                        } else if (label[inblossom[w]] == S_LABEL) {
+                            const node_idx_t b = inblossom[v];
+                            if (bestedge[b] == -1 || kslack < slack(bestedge[b])) {
+                                bestedge[b] = k;
+                            }
+                        } else if (label[w] == FREE) {
+                            if (bestedge[w] == -1 || kslack < slack(bestedge[w])) {
+                                bestedge[w] = k;
+                            }
+                        }
+                    }
+                }
+                if (augmented) {
+                    break;
+                }
+
+                // No tight edge to follow, change the duals. Type 1 ends the stage
+                int deltatype = 1;
+                long long delta = *std::min_element(dualvar.begin(), dualvar.begin() + n);
+                int deltaedge = -1;
+                node_idx_t deltablossom = -1;
+                for (node_idx_t v = 0; v < n; ++v) {
+                    if (label[inblossom[v]] == FREE && bestedge[v] != -1) {
+                        const long long d = slack(bestedge[v]);
+                        if (d < delta) {
+                            delta = d;
+                            deltatype = 2;
+                            deltaedge = bestedge[v];
+                        }
+                    }
+                }
+                for (node_idx_t b = 0; b < 2 * n; ++b) {
+                    if (blossomparent[b] == -1 && label[b] == S_LABEL && bestedge[b] != -1) {
+                        const long long d = slack(bestedge[b]) / 2;
+                        if (d < delta) {
+                            delta = d;
+                            deltatype = 3;
+                            deltaedge = bestedge[b];
+                        }
+                    }
+                }
+                for (node_idx_t b = n; b < 2 * n; ++b) {
+                    if (blossombase[b] >= 0 && blossomparent[b] == -1 && label[b] == T_LABEL && dualvar[b] < delta) {
+                        delta = dualvar[b];
+                        deltatype = 4;
+                        deltablossom = b;
+                    }
+                }
+
+                for (node_idx_t v = 0; v < n; ++v) {
+                    if (label[inblossom[v]] == S_LABEL) {
+                        dualvar[v] -= delta;
+                    } else if (label[inblossom[v]] == T_LABEL) {
+                        dualvar[v] += delta;
+                    }
+                }
+                for (node_idx_t b = n; b < 2 * n; ++b) {
+                    if (blossombase[b] >= 0 && blossomparent[b] == -1) {
+                        if (label[b] == S_LABEL) {
+                            dualvar[b] += delta;
+                        } else if (label[b] == T_LABEL) {
+                            dualvar[b] -= delta;
+                        }
+                    }
+                }
+
+                if (deltatype == 1) {
+                    break;
+                } else if (deltatype == 2) {
+                    allowedge[deltaedge] = true;
+                    node_idx_t i = endpoint[2 * deltaedge];
+                    if (label[inblossom[i]] == FREE) {
+                        i = endpoint[2 * deltaedge + 1];
+                    }
+                    queue.push_back(i);
+                } else if (deltatype == 3) {
+                    allowedge[deltaedge] = true;
+                    queue.push_back(endpoint[2 * deltaedge]);
+                } else {
+                    expand_blossom(deltablossom, false);
+                }
+            }
+            if (!augmented) {
+                return false;
+            }
+            // Blossoms with zero dual can be expanded, so they do not grow for no reason in the next stages
+            for (node_idx_t b = n; b < 2 * n; ++b) {
+                if (blossomparent[b] == -1 && blossombase[b] >= 0 && label[b] == S_LABEL && dualvar[b] == 0) {
+                    expand_blossom(b, true);
+                }
+            }
+            return true;
+        }
+    };
+}
+
+std::vector<node_idx_t> max_weight_matching(node_idx_t n, const std::vector<std::pair<node_idx_t, node_idx_t>> &edges,
+                                            const std::vector<long long> &weights, long long max_time_us,
+                                            bool *finished) {
+    if (finished) {
+        *finished = true;
+    }
+    if (edges.empty()) {
+        return std::vector<node_idx_t>(n, -1);
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(max_time_us);
+    BlossomMatching matching{n, edges, weights, max_time_us >= 0 ? &deadline : nullptr};
+    auto res = matching.solve();
+    if (finished) {
+        *finished = matching.finished();
+    }
+    return res;
+}
+
+namespace {
+    //! Take edges from the heaviest one on whenever both of their vertices are still free
+    std::vector<node_idx_t> greedy_matching(node_idx_t n, const std::vector<std::pair<node_idx_t, node_idx_t>> &edges,
+                                            const std::vector<long long> &weights) {
+        std::vector<size_t> by_weight(edges.size());
+        std::iota(by_weight.begin(), by_weight.end(), 0);
+        std::sort(by_weight.begin(), by_weight.end(), [&](size_t a, size_t b) { return weights[a] > weights[b]; });
+        std::vector<node_idx_t> mates(n, -1);
+        for (size_t k: by_weight) {
+            const node_idx_t u = edges[k].first, v = edges[k].second;
+            if (mates[u] == -1 && mates[v] == -1) {
+                mates[u] = v;
+                mates[v] = u;
+            }
+        }
+        return mates;
+    }
+
+    /*!
+     * Turn a matching of the mutual pairs into a solution. Unmatched nodes point to a matched node if they can, which
+     * never closes a cycle, or to a node that does not point back to them
+     * @param vertex Vertex of each node in the matching, -1 for nodes without a mutual arc
+     * @param node_of Node of each vertex
+     */
+    std::vector<node_idx_t> matching_to_solution(const Problem &p, const std::vector<node_idx_t> &vertex,
+                                                 const std::vector<node_idx_t> &node_of,
+                                                 const std::vector<node_idx_t> &mates) {
+        std::vector<node_idx_t> successor(p.n, -1);
+        for (size_t i = 0; i < mates.size(); ++i) {
+            if (mates[i] != -1) {
+                successor[node_of[i]] = node_of[mates[i]];
+            }
+        }
+        for (node_idx_t u = 0; u < p.n; ++u) {
+            if (successor[u] != -1 || p.adj_l[u].empty()) {
+                continue;
+            }
+            node_idx_t best = p.adj_l[u][0].first;
+            for (const auto &arc: p.adj_l[u]) {
+                const node_idx_t v = arc.first;
+                if (v != u && successor[v] != u) {
+                    best = v;
+                    if (vertex[v] != -1 && mates[vertex[v]] != -1) {
+                        break;
+                    }
+                }
+            }
+            successor[u] = best;
+        }
+
+        std::vector<node_idx_t> solution(p.n);
+        for (node_idx_t u = 0; u < p.n; ++u) {
+            for (node_idx_t i = 0; i < static_cast<node_idx_t>(p.adj_l[u].size()); ++i) {
+                if (p.adj_l[u][i].first == successor[u]) {
+                    solution[u] = i;
+                    break;
+                }
+            }
+        }
+        return solution;
+    }
+}
+
+std::vector<node_idx_t> solve_pair_matching(const Problem &p, long long max_time_us,
+                                            const new_best_callback_t &on_new_best) {
+    auto start_time = std::chrono::steady_clock::now();
+    TraceSpan span{"pair_matching"};
+    // Only nodes with a mutual arc take part in the matching, numbered densely
+    std::vector<node_idx_t> vertex(p.n, -1);
+    std::vector<node_idx_t> node_of;
+    std::vector<std::pair<node_idx_t, node_idx_t>> edges;
+    std::vector<long long> weights;
+    for (node_idx_t u = 0; u < p.n; ++u) {
+        for (const auto &arc: p.adj_l[u]) {
+            const node_idx_t v = arc.first;
+            if (u >= v || !p.has_arc(v, u)) {
+                continue;
+            }
+            const long long weight = std::llround((static_cast<double>(arc.second) + p.w[v][u]) * WEIGHT_SCALE);
+            if (weight <= 0) {
+                continue;
+            }
+            for (node_idx_t x: {u, v}) {
+                if (vertex[x] == -1) {
+                    vertex[x] = static_cast<node_idx_t>(node_of.size());
+                    node_of.push_back(x);
+                }
+            }
+            edges.emplace_back(vertex[u], vertex[v]);
+            weights.push_back(weight);
+        }
+    }
+    const auto vertices = static_cast<node_idx_t>(node_of.size());
+    span.set_arg("vertices", static_cast<long long>(vertices));
+    span.set_arg("edges", static_cast<long long>(edges.size()));
+
+    // The greedy matching is at least half of the optimum and is ready in a moment, so there is a solution even if the
+    // exact one does not make it in time
+    auto solution = matching_to_solution(p, vertex, node_of, greedy_matching(vertices, edges, weights));
+    auto cost = get_solution_cost(p, solution);
+    if (on_new_best) {
+        on_new_best(solution, cost);
+    }
+
+    if (max_time_us >= 0) {
+        max_time_us = std::max(0ll, max_time_us - std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start_time).count());
+    }
+    bool finished = true;
+    const auto mates = max_weight_matching(vertices, edges, weights, max_time_us, &finished);
+    span.set_arg("finished", finished);
+    auto exact_solution = matching_to_solution(p, vertex, node_of, mates);
+    auto exact_cost = get_solution_cost(p, exact_solution);
+    // A matching stopped early may still be worse than the greedy one
+    if (finished || exact_cost > cost) {
+        solution = std::move(exact_solution);
+        if (exact_cost != cost && on_new_best) {
+            on_new_best(solution, exact_cost);
+        }
+    }
+    return solution;
+}
@@ -0,0 +1,41 @@
+#ifndef COCONTEST_HEURISTICS_MATCHING_H
+#define COCONTEST_HEURISTICS_MATCHING_H
+
+#include <vector>
+#include <utility>
+#include "common_types.h"
+#include "Problem.h"
+#include "tabu_search.h"
+
+/*!
+ * Find a maximum weight matching in a general undirected graph with Edmonds' blossom algorithm, in the primal-dual
+ * formulation of Galil with O(n^3) time. Weights are integers, so all the dual variables stay integral and the result
+ * is exact
+ * @param n Number of vertices
+ * @param edges Edges as pairs of vertices {u, v}, u != v
+ * @param weights Weight of each edge
+ * @param max_time_us Time limit in microseconds, negative for none. When it runs out or the search is asked to stop
+ * (see request_tabu_search_stop), the matching found so far is returned. It is valid, but not of maximum weight
+ * @param finished If not null, set to false if the matching was returned before it was optimal
+ * @return Mate of each vertex, or -1 if the vertex is not matched
+ */
+std::vector<node_idx_t> max_weight_matching(node_idx_t n, const std::vector<std::pair<node_idx_t, node_idx_t>> &edges,
+                                            const std::vector<long long> &weights, long long max_time_us = -1,
+                                            bool *finished = nullptr);
+
+/*!
+ * Solve the problem with L = 2 exactly. Every valid cycle is then a pair of mutual arcs u->v, v->u, so the best
+ * solution is a maximum weight matching of the graph with an edge {u, v} of weight w[u][v] + w[v][u] for each such
+ * pair. Weights are rounded to WEIGHT_SCALE-th of a unit for the matching. A greedy matching is reported first, so a
+ * solution is ready even if the exact one runs out of time
+ * @param p Problem with p.L == 2
+ * @param max_time_us Time limit in microseconds, negative for none. The better of the greedy matching and the one the
+ * exact search got to is returned if it runs out
+ * @param on_new_best Called with the greedy solution and then with the final one if it is better. May be empty
+ * @return Solution to the problem as list of successor indices for each node. Nodes out of the matching point to
+ * a successor that does not close a cycle of length 2 with them whenever they have one
+ */
+std::vector<node_idx_t> solve_pair_matching(const Problem &p, long long max_time_us = -1,
+                                            const new_best_callback_t &on_new_best = new_best_callback_t());
+
+#endif //COCONTEST_HEURISTICS_MATCHING_H
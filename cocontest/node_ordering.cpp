@@ -0,0 +1,170 @@
+#include "node_ordering.h"
+#include <algorithm>
+#include <numeric>
+#include "trace.h"
+
+namespace {
+    using neighbours_t = std::vector<std::vector<node_idx_t>>;
+
+    // Neighbours of each node regardless of the arc direction, without duplicates of mutual arcs
+    neighbours_t undirected_neighbours(const Problem &p) {
+        neighbours_t res(p.n);
+        for (node_idx_t v = 0; v < p.n; ++v) {
+            for (node_idx_t i = p.arc_offset[v]; i < p.arc_offset[v + 1]; ++i) {
+                res[v].push_back(p.arc_to[i]);
+                res[p.arc_to[i]].push_back(v);
+            }
+        }
+        for (auto &l: res) {
+            std::sort(l.begin(), l.end());
+            l.erase(std::unique(l.begin(), l.end()), l.end());
+        }
+        return res;
+    }
+
+    // Append all unvisited nodes reachable from root to order in BFS order, visiting neighbours in the order of lists
+    void bfs(const neighbours_t &neighbours, node_idx_t root, std::vector<char> &visited,
+             std::vector<node_idx_t> &order) {
+        size_t head = order.size();
+        visited[root] = true;
+        order.push_back(root);
+        for (; head < order.size(); ++head) {
+            for (node_idx_t u: neighbours[order[head]]) {
+                if (!visited[u]) {
+                    visited[u] = true;
+                    order.push_back(u);
+                }
+            }
+        }
+    }
+
+    /*
+     * Find a node far from the others in the component of start (George-Liu). Start a BFS from the node, and while
+     * the BFS from the lowest degree node of the last level has more levels, continue from that node. Level has to be -1
+     * for all nodes and is left so
+     */
+    node_idx_t pseudo_peripheral_node(const neighbours_t &neighbours, node_idx_t start, std::vector<node_idx_t> &level) {
+        std::vector<node_idx_t> queue;
+        node_idx_t root = start;
+        node_idx_t eccentricity = -1;
+        while (true) {
+            level[root] = 0;
+            queue.clear();
+            queue.push_back(root);
+            for (size_t head = 0; head < queue.size(); ++head) {
+                for (node_idx_t u: neighbours[queue[head]]) {
+                    if (level[u] < 0) {
+                        level[u] = level[queue[head]] + 1;
+                        queue.push_back(u);
+                    }
+                }
+            }
+            const node_idx_t last_level = level[queue.back()];
+            node_idx_t next = queue.back();
+            for (auto it = queue.rbegin(); it != queue.rend() && level[*it] == last_level; ++it) {
+                if (neighbours[*it].size() < neighbours[next].size()) {
+                    next = *it;
+                }
+            }
+            for (node_idx_t v: queue) {
+                level[v] = -1;
+            }
+            if (last_level <= eccentricity) {
+                return root;
+            }
+            eccentricity = last_level;
+            root = next;
+        }
+    }
+
+    std::vector<node_idx_t> bfs_order(const Problem &p) {
+        const auto neighbours = undirected_neighbours(p);
+        std::vector<char> visited(p.n);
+        std::vector<node_idx_t> order;
+        order.reserve(p.n);
+        for (node_idx_t v = 0; v < p.n; ++v) {
+            if (!visited[v]) {
+                bfs(neighbours, v, visited, order);
+            }
+        }
+        return order;
+    }
+
+    std::vector<node_idx_t> rcm_order(const Problem &p) {
+        auto neighbours = undirected_neighbours(p);
+        auto by_degree = [&](node_idx_t a, node_idx_t b) {
+            return neighbours[a].size() < neighbours[b].size();
+        };
+        for (auto &l: neighbours) {
+            std::stable_sort(l.begin(), l.end(), by_degree);
+        }
+        std::vector<node_idx_t> roots(p.n);
+        std::iota(roots.begin(), roots.end(), 0);
+        std::stable_sort(roots.begin(), roots.end(), by_degree);
+
+        std::vector<char> visited(p.n);
+        std::vector<node_idx_t> level(p.n, -1);
+        std::vector<node_idx_t> order;
+        order.reserve(p.n);
+        for (node_idx_t v: roots) {
+            if (!visited[v]) {
+                bfs(neighbours, pseudo_peripheral_node(neighbours, v, level), visited, order);
+            }
+        }
+        std::reverse(order.begin(), order.end());
+        return order;
+    }
+}
+
+bool parse_node_ordering(const std::string &name, NodeOrdering &ordering) {
+    if (name == "none") {
+        ordering = NodeOrdering::NONE;
+    } else if (name == "bfs") {
+        ordering = NodeOrdering::BFS;
+    } else if (name == "rcm") {
+        ordering = NodeOrdering::RCM;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char *node_ordering_name(NodeOrdering ordering) {
+    switch (ordering) {
+        case NodeOrdering::BFS:
+            return "bfs";
+        case NodeOrdering::RCM:
+            return "rcm";
+        default:
+            return "none";
+    }
+}
+
+std::vector<node_idx_t> node_order(const Problem &p, NodeOrdering ordering) {
+    TraceSpan span{"node_order"};
+    switch (ordering) {
+        case NodeOrdering::BFS:
+            return bfs_order(p);
+        case NodeOrdering::RCM:
+            return rcm_order(p);
+        default: {
+            std::vector<node_idx_t> identity(p.n);
+            std::iota(identity.begin(), identity.end(), 0);
+            return identity;
+        }
+    }
+}
+
+Problem relabel_nodes(const Problem &p, const std::vector<node_idx_t> &original_id) {
+    TraceSpan span{"relabel_nodes"};
+    std::vector<node_idx_t> new_id(p.n);
+    for (node_idx_t i = 0; i < p.n; ++i) {
+        new_id[original_id[i]] = i;
+    }
+    auto arcs = p.arcs();
+    for (auto &a: arcs) {
+        a.from = new_id[a.from];
+        a.to = new_id[a.to];
+    }
+    return Problem::from_arcs(p.n, p.L, arcs);
+}
@@ -0,0 +1,44 @@
+#ifndef COCONTEST_HEURISTICS_NODE_ORDERING_H
+#define COCONTEST_HEURISTICS_NODE_ORDERING_H
+
+#include <vector>
+#include <string>
+#include "common_types.h"
+#include "Problem.h"
+
+/*!
+ * Order in which nodes are relabeled before the search. Node ids of the input are arbitrary, so walking successors
+ * jumps randomly through the per-node arrays. Both orderings number nodes that are close in the graph (ignoring the
+ * arc directions) close to each other, so nodes of one cycle tend to share cache lines
+ */
+enum class NodeOrdering {
+    NONE, // Keep the ids of the input
+    BFS, // Breadth-first search from the lowest unvisited id of each component
+    RCM // Reverse Cuthill-McKee: BFS from a pseudo-peripheral node visiting low degree neighbours first, reversed
+};
+
+/*!
+ * Parse the name of the ordering ("none", "bfs" or "rcm")
+ * @return True if the name is valid
+ */
+bool parse_node_ordering(const std::string &name, NodeOrdering &ordering);
+
+const char *node_ordering_name(NodeOrdering ordering);
+
+/*!
+ * Compute the new order of nodes
+ * @param p Problem to reorder
+ * @param ordering Ordering to use
+ * @return Original id of each new node. Identity for NodeOrdering::NONE
+ */
+std::vector<node_idx_t> node_order(const Problem &p, NodeOrdering ordering);
+
+/*!
+ * Create a copy of the problem with node i of the copy being node original_id[i] of p
+ * @param p Problem to relabel
+ * @param original_id Permutation of the nodes as returned by node_order
+ * @return Relabeled problem
+ */
+Problem relabel_nodes(const Problem &p, const std::vector<node_idx_t> &original_id);
+
+#endif //COCONTEST_HEURISTICS_NODE_ORDERING_H
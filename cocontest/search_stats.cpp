@@ -0,0 +1,81 @@
+#include "search_stats.h"
+#include <fstream>
+
+void SearchStats::reset() {
+    for (auto &o: operators) {
+        o = OperatorStats();
+    }
+    iterations = 0;
+    neighbourhood_probes = 0;
+    search_time_s = 0;
+    incumbent_trace.clear();
+    start_time = std::chrono::steady_clock::now();
+}
+
+void SearchStats::record_incumbent(weight_t cost) {
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    incumbent_trace.emplace_back(elapsed, cost);
+}
+
+SearchStats &search_stats() {
+    static SearchStats stats;
+    return stats;
+}
+
+const char *operator_name(SearchOperator op) {
+    switch (op) {
+        case SearchOperator::CREATE_RANDOM_CYCLE:
+            return "create_random_cycle";
+        case SearchOperator::ADD_TO_CYCLES:
+            return "add_to_cycles";
+        case SearchOperator::BREAK_RANDOM_CYCLE:
+            return "break_random_cycle";
+        case SearchOperator::SHORTEN_LONG_CYCLES:
+            return "shorten_long_cycles";
+        default:
+            return "unknown";
+    }
+}
+
+namespace {
+    // Division that gives 0 instead of nan/inf, as these are not valid JSON
+    double safe_div(double a, double b) {
+        return b == 0 ? 0 : a / b;
+    }
+}
+
+bool write_search_stats_json(const SearchStats &stats, const std::string &filename) {
+    std::ofstream os{filename};
+    if (!os) {
+        return false;
+    }
+    os.precision(10);
+    os << "{\n";
+    os << "  \"iterations\": " << stats.iterations << ",\n";
+    os << "  \"neighbourhood_probes\": " << stats.neighbourhood_probes << ",\n";
+    os << "  \"search_time_s\": " << stats.search_time_s << ",\n";
+    os << "  \"iterations_per_s\": " << safe_div(stats.iterations, stats.search_time_s) << ",\n";
+    os << "  \"probes_per_s\": " << safe_div(stats.neighbourhood_probes, stats.search_time_s) << ",\n";
+    os << "  \"operators\": {\n";
+    for (int i = 0; i < static_cast<int>(SearchOperator::COUNT); ++i) {
+        const auto &o = stats.operators[i];
+        os << "    \"" << operator_name(static_cast<SearchOperator>(i)) << "\": {"
+           << "\"calls\": " << o.calls
+           << ", \"successes\": " << o.successes
+           << ", \"success_rate\": " << safe_div(o.successes, o.calls)
+           << ", \"time_s\": " << o.time_ns * 1e-9
+           << ", \"mean_time_us\": " << safe_div(o.time_ns * 1e-3, o.calls)
+           << ", \"total_gain\": " << o.gain
+           << ", \"mean_gain\": " << safe_div(o.gain, o.calls)
+           << "}" << (i + 1 < static_cast<int>(SearchOperator::COUNT) ? "," : "") << "\n";
+    }
+    os << "  },\n";
+    os << "  \"incumbent_trace\": [";
+    for (size_t i = 0; i < stats.incumbent_trace.size(); ++i) {
+        os << (i == 0 ? "\n    " : ",\n    ") << "[" << stats.incumbent_trace[i].first << ", "
+           << stats.incumbent_trace[i].second << "]";
+    }
+    os << "\n  ]\n";
+    os << "}\n";
+    return static_cast<bool>(os);
+}
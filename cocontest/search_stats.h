@@ -0,0 +1,74 @@
+#ifndef COCONTEST_HEURISTICS_SEARCH_STATS_H
+#define COCONTEST_HEURISTICS_SEARCH_STATS_H
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include "common_types.h"
+
+/*!
+ * Neighbourhood operators of the tabu search (see heuristics.h)
+ */
+enum class SearchOperator {
+    CREATE_RANDOM_CYCLE = 0,
+    ADD_TO_CYCLES,
+    BREAK_RANDOM_CYCLE,
+    SHORTEN_LONG_CYCLES,
+    COUNT
+};
+
+/*!
+ * Counters of one operator
+ */
+struct OperatorStats {
+    uint64_t calls = 0;
+    uint64_t successes = 0; // Calls that returned true (changed the solution)
+    uint64_t time_ns = 0; // Time spent inside the operator itself
+    double gain = 0; // Sum of solution cost changes caused by the operator
+};
+
+/*!
+ * Statistics collected by solve_tabu_search. Iteration and probe counters and the incumbent trace are always collected
+ * as they cost almost nothing. Per-operator statistics are off by default and each hook costs only a check of the
+ * enabled flag then. When enabled, each operator call is timed and the solution is evaluated before and after it
+ * to get the gain, so the search itself becomes slower
+ */
+struct SearchStats {
+    bool enabled = false; // Collect per-operator statistics
+    OperatorStats operators[static_cast<int>(SearchOperator::COUNT)];
+    uint64_t iterations = 0; // Iterations of the main loop
+    uint64_t neighbourhood_probes = 0; // Evaluated neighbour solutions
+    double search_time_s = 0;
+    // Pairs <seconds since the search start, cost> for every new best solution
+    std::vector<std::pair<double, weight_t>> incumbent_trace;
+    std::chrono::steady_clock::time_point start_time;
+
+    // Clear all the counters and restart the clock. Keeps the enabled flag. Called at the start of each search
+    void reset();
+
+    void record_incumbent(weight_t cost);
+
+    OperatorStats &of(SearchOperator op) {
+        return operators[static_cast<int>(op)];
+    }
+};
+
+/*!
+ * Global statistics instance filled by the tabu search
+ */
+SearchStats &search_stats();
+
+/*!
+ * Name of the operator as used in the JSON output
+ */
+const char *operator_name(SearchOperator op);
+
+/*!
+ * Write statistics to a JSON file
+ * @return True if the file was written successfully
+ */
+bool write_search_stats_json(const SearchStats &stats, const std::string &filename);
+
+#endif //COCONTEST_HEURISTICS_SEARCH_STATS_H
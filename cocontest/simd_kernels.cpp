@@ -0,0 +1,125 @@
+#include "simd_kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COCONTEST_AVX2_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace {
+    size_t and3_rows_scalar(const uint64_t *a, const uint64_t *b, const uint64_t *c, uint64_t *out, size_t words) {
+        size_t count = 0;
+        for (size_t i = 0; i < words; ++i) {
+            out[i] = a[i] & b[i] & c[i];
+            count += __builtin_popcountll(out[i]);
+        }
+        return count;
+    }
+
+    void gather_successors_scalar(const node_idx_t *offsets, const node_idx_t *solution, const node_idx_t *arc_to,
+                                  const weight_t *arc_w, node_idx_t *succ, weight_t *succ_w, size_t n) {
+        for (size_t v = 0; v < n; ++v) {
+            auto arc = offsets[v] + solution[v];
+            succ[v] = arc_to[arc];
+            succ_w[v] = arc_w[arc];
+        }
+    }
+
+    weight_t masked_sum_scalar(const weight_t *values, const int32_t *lengths, int32_t max_length, size_t n) {
+        weight_t sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (lengths[i] > 0 && lengths[i] <= max_length) {
+                sum += values[i];
+            }
+        }
+        return sum;
+    }
+
+#ifdef COCONTEST_AVX2_KERNELS
+    __attribute__((target("avx2,popcnt")))
+    size_t and3_rows_avx2(const uint64_t *a, const uint64_t *b, const uint64_t *c, uint64_t *out, size_t words) {
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + 4 <= words; i += 4) {
+            __m256i x = _mm256_and_si256(
+                    _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)),
+                                     _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i))),
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(c + i)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), x);
+            // Rows are sparse, so most blocks are empty and need no popcount
+            if (!_mm256_testz_si256(x, x)) {
+                count += __builtin_popcountll(out[i]) + __builtin_popcountll(out[i + 1]) +
+                         __builtin_popcountll(out[i + 2]) + __builtin_popcountll(out[i + 3]);
+            }
+        }
+        for (; i < words; ++i) {
+            out[i] = a[i] & b[i] & c[i];
+            count += __builtin_popcountll(out[i]);
+        }
+        return count;
+    }
+
+    // Works with 64-bit node indices only, selected only when node_idx_t has 64 bits
+    __attribute__((target("avx2")))
+    void gather_successors_avx2(const node_idx_t *offsets, const node_idx_t *solution, const node_idx_t *arc_to,
+                                const weight_t *arc_w, node_idx_t *succ, weight_t *succ_w, size_t n) {
+        const auto *to = reinterpret_cast<const long long *>(arc_to);
+        size_t v = 0;
+        for (; v + 4 <= n; v += 4) {
+            __m256i arc = _mm256_add_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(offsets + v)),
+                                           _mm256_loadu_si256(reinterpret_cast<const __m256i *>(solution + v)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(succ + v), _mm256_i64gather_epi64(to, arc, 8));
+            _mm_storeu_ps(reinterpret_cast<float *>(succ_w + v),
+                          _mm256_i64gather_ps(reinterpret_cast<const float *>(arc_w), arc, 4));
+        }
+        gather_successors_scalar(offsets + v, solution + v, arc_to, arc_w, succ + v, succ_w + v, n - v);
+    }
+
+    __attribute__((target("avx2")))
+    weight_t masked_sum_avx2(const weight_t *values, const int32_t *lengths, int32_t max_length, size_t n) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i max_len = _mm256_set1_epi32(max_length);
+        __m256 acc = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i len = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lengths + i));
+            // 0 < len && !(len > max_len)
+            __m256i mask = _mm256_andnot_si256(_mm256_cmpgt_epi32(len, max_len), _mm256_cmpgt_epi32(len, zero));
+            __m256 v = _mm256_loadu_ps(reinterpret_cast<const float *>(values + i));
+            acc = _mm256_add_ps(acc, _mm256_and_ps(_mm256_castsi256_ps(mask), v));
+        }
+        __m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+        sum4 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+        sum4 = _mm_add_ss(sum4, _mm_shuffle_ps(sum4, sum4, 1));
+        return _mm_cvtss_f32(sum4) + masked_sum_scalar(values + i, lengths + i, max_length, n - i);
+    }
+#endif
+
+    SimdKernels select_kernels() {
+        SimdKernels kernels = scalar_kernels();
+#ifdef COCONTEST_AVX2_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+            kernels.and3_rows = and3_rows_avx2;
+            // Gather and masked sum kernels are written for 64-bit node indices and 32-bit weights
+            if (sizeof(node_idx_t) == sizeof(long long)) {
+                kernels.gather_successors = gather_successors_avx2;
+            }
+            if (sizeof(weight_t) == sizeof(float)) {
+                kernels.masked_sum = masked_sum_avx2;
+            }
+            kernels.name = "avx2";
+        }
+#endif
+        return kernels;
+    }
+}
+
+const SimdKernels &scalar_kernels() {
+    static const SimdKernels kernels = {and3_rows_scalar, gather_successors_scalar, masked_sum_scalar, "scalar"};
+    return kernels;
+}
+
+const SimdKernels &simd_kernels() {
+    static const SimdKernels kernels = select_kernels();
+    return kernels;
+}
@@ -0,0 +1,44 @@
+#ifndef COCONTEST_HEURISTICS_SIMD_KERNELS_H
+#define COCONTEST_HEURISTICS_SIMD_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include "common_types.h"
+
+/*!
+ * Data-parallel kernels used in solution evaluation and candidate filtering. An AVX2 implementation is selected at
+ * runtime if the CPU supports it, a portable scalar one otherwise
+ */
+struct SimdKernels {
+    /*!
+     * out[i] = a[i] & b[i] & c[i] for each of the words
+     * @return Number of set bits in out
+     */
+    size_t (*and3_rows)(const uint64_t *a, const uint64_t *b, const uint64_t *c, uint64_t *out, size_t words);
+
+    /*!
+     * For each node v: succ[v] = arc_to[offsets[v] + solution[v]], succ_w[v] = arc_w[offsets[v] + solution[v]]
+     */
+    void (*gather_successors)(const node_idx_t *offsets, const node_idx_t *solution, const node_idx_t *arc_to,
+                              const weight_t *arc_w, node_idx_t *succ, weight_t *succ_w, size_t n);
+
+    /*!
+     * Sum of values[i] over all i with 0 < lengths[i] <= max_length
+     */
+    weight_t (*masked_sum)(const weight_t *values, const int32_t *lengths, int32_t max_length, size_t n);
+
+    // Name of the selected implementation
+    const char *name;
+};
+
+/*!
+ * Kernels for the current CPU. Selected on the first call
+ */
+const SimdKernels &simd_kernels();
+
+/*!
+ * Portable kernels. Exposed to be able to compare them with the selected ones
+ */
+const SimdKernels &scalar_kernels();
+
+#endif //COCONTEST_HEURISTICS_SIMD_KERNELS_H
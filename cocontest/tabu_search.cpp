@@ -4,28 +4,46 @@
 #include "tabu_search.h"
 #include <stack>
 #include "heuristics.h"
+#include "search_stats.h"
+#include "trace.h"
+#include "simd_kernels.h"
 #include <list>
 #include <iostream>
 #include <chrono>
 #include <random>
 #include <algorithm>
+#include <csignal>
 
 using solution_t = std::vector<node_idx_t>;
 
 namespace {
     const int P_CYCLE = 25;
-    int P_BREAK = 60;
+    const int P_BREAK = 60;
+    const int P_BREAK_LARGE = 20;
     const int P_SHORTEN = 7;
     const int RANDOM_CYCLE_ORDER_PROB = 5;
-    int INITIAL_SOLUTIONS = 20;
+    const int INITIAL_SOLUTIONS = 20;
+    const int INITIAL_SOLUTIONS_LARGE = 3;
     const int P_ADD = 50;
     const size_t MAX_TABU_LIST_SIZE = 1000;
     const int TIME_MEASUREMENT_ITERATIONS = 1;
-    int ITERATIONS_PER_NEIGHBOURHOOD_SEARCH = 15;
+    // Operator calls of the initial construction between two reads of the clock
+    const int CONSTRUCTION_TIME_MEASUREMENT_STEPS = 64;
+    const int ITERATIONS_PER_NEIGHBOURHOOD_SEARCH = 15;
+    // Instances with more nodes than this use the *_LARGE parameters
+    const node_idx_t LARGE_INSTANCE_NODES = 5000;
 
 
+    // Set asynchronously (e.g. from a signal handler) to finish the search early
+    volatile std::sig_atomic_t stop_requested = 0;
+
     // Using the same buffer all the time
     std::vector<bool> visited;
+    // Buffers of get_solution_cost
+    std::vector<node_idx_t> succ;
+    std::vector<weight_t> succ_w;
+    std::vector<int32_t> cycle_length;
+    std::vector<node_idx_t> walk_id;
 
     void zero_visited(size_t n) {
         visited.resize(n);
@@ -33,10 +51,8 @@ namespace {
     }
 
     int get_random_prob() {
-        static std::random_device dev;
-        static std::mt19937 rng(dev());
         static std::uniform_int_distribution<int> dist(0, 100);
-        return dist(rng);
+        return dist(random_engine());
     }
 
     /*!
@@ -56,49 +72,142 @@ namespace {
         return seed;
     }
 
+    /*!
+     * Run a single neighbourhood operator and record its statistics if they are enabled
+     * @param op Operator type for statistics
+     * @param f Function applying the operator to the solution. Returns true if the solution was changed
+     * @return Result of f
+     */
+    template<typename F>
+    bool run_operator(SearchOperator op, const Problem &p, const std::vector<node_idx_t> &solution, F f) {
+        auto &stats = search_stats();
+        if (!stats.enabled) {
+            return f();
+        }
+        auto cost_before = get_solution_cost(p, solution);
+        auto start = std::chrono::steady_clock::now();
+        bool res = f();
+        auto end = std::chrono::steady_clock::now();
+        auto &op_stats = stats.of(op);
+        ++op_stats.calls;
+        op_stats.successes += res;
+        op_stats.time_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        op_stats.gain += get_solution_cost(p, solution) - cost_before;
+        return res;
+    }
+
 }
 
 weight_t get_solution_cost(const Problem &p, const solution_t &solution) {
-    weight_t cost = 0;
-    auto cycles = find_cycles(p, solution);
-    for (const auto &c: cycles) {
-        if (c.size() > p.L) {
+    const auto &kernels = simd_kernels();
+    const size_t n = p.n;
+    succ.resize(n);
+    succ_w.resize(n);
+    kernels.gather_successors(p.arc_offset.data(), solution.data(), p.arc_to.data(), p.arc_w.data(), succ.data(),
+                              succ_w.data(), n);
+
+    // Each node has exactly one successor, so each walk ends either in a new cycle or in an already processed node
+    cycle_length.assign(n, 0);
+    walk_id.assign(n, -1);
+    for (node_idx_t start = 0; start < p.n; ++start) {
+        if (walk_id[start] != -1) {
             continue;
         }
-        for (size_t i = 0; i < c.size(); ++i) {
-            cost += p.w[c[i]][c[(i + 1) % c.size()]];
+        node_idx_t v = start;
+        while (walk_id[v] == -1) {
+            walk_id[v] = start;
+            v = succ[v];
+        }
+        if (walk_id[v] != start) {
+            continue;
+        }
+        // v is on a new cycle
+        int32_t length = 1;
+        for (node_idx_t u = succ[v]; u != v; u = succ[u]) {
+            ++length;
+        }
+        cycle_length[v] = length;
+        for (node_idx_t u = succ[v]; u != v; u = succ[u]) {
+            cycle_length[u] = length;
         }
     }
 
-    return cost;
+    return kernels.masked_sum(succ_w.data(), cycle_length.data(), static_cast<int32_t>(p.L), n);
 }
 
+void request_tabu_search_stop() {
+    stop_requested = 1;
+}
 
-solution_t solve_tabu_search(const Problem &p, solution_t solution, long long max_time_us) {
+bool is_tabu_search_stop_requested() {
+    return stop_requested != 0;
+}
+
+
+solution_t solve_tabu_search(const Problem &p, solution_t solution, long long max_time_us, const TabuSearchOptions &options) {
     auto start_time = std::chrono::high_resolution_clock::now();
+    // The first initial solution may use the time up to the limit itself, as the margin could leave none for it
+    const long long time_limit_us = max_time_us;
 
-    long long threshold_time = std::max(100000ll, max_time_us / 200000 * p.n);
-    max_time_us = max_time_us - threshold_time;
+    if (options.use_time_margin) {
+        long long threshold_time = std::max(100000ll, max_time_us / 200000 * p.n);
+        max_time_us = max_time_us - threshold_time;
+    }
     // If the instance is very large, decrease some parameters to make more iterations with less random
-    if (p.n > 5000) {
-        ITERATIONS_PER_NEIGHBOURHOOD_SEARCH /= 5;
-        INITIAL_SOLUTIONS = 3;
-        P_BREAK = 20;
-        max_time_us -= 1000000;
+    int p_break = P_BREAK;
+    int initial_solutions = INITIAL_SOLUTIONS;
+    int iterations_per_neighbourhood_search = ITERATIONS_PER_NEIGHBOURHOOD_SEARCH;
+    if (p.n > LARGE_INSTANCE_NODES) {
+        iterations_per_neighbourhood_search /= 5;
+        initial_solutions = INITIAL_SOLUTIONS_LARGE;
+        p_break = P_BREAK_LARGE;
+        if (options.use_time_margin) {
+            max_time_us -= 1000000;
+        }
     }
 
+    auto &stats = search_stats();
+    stats.reset();
+
     solution_t best_solution = solution;
     auto best_solution_cost = get_solution_cost(p, best_solution);
+    auto out_of_time = [&](long long limit_us) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - start_time).count() >= limit_us;
+    };
+    auto report_new_best = [&]() {
+        stats.record_incumbent(best_solution_cost);
+        if (options.on_new_best) {
+            options.on_new_best(best_solution, best_solution_cost);
+        }
+    };
 
-    for (int i = 0; i < INITIAL_SOLUTIONS; ++i) {
-        auto init_solution = solution;
-        while (create_random_cycle(p, init_solution, false)) {}
-        while (add_to_cycles(p, init_solution)) {};
-        auto cost = get_solution_cost(p, init_solution);
-        if (cost > best_solution_cost) {
-            best_solution_cost = cost;
-            best_solution = init_solution;
+    // Report the starting solution, so there is one to write even if the construction gets interrupted
+    report_new_best();
+
+    {
+        TraceSpan initial_span{"initial_construction"};
+        int i = 0;
+        size_t steps = 0;
+        // A partly built solution is still valid, so the construction may stop at any step
+        auto keep_building = [&]() {
+            return !stop_requested && (++steps % CONSTRUCTION_TIME_MEASUREMENT_STEPS != 0 ||
+                                       !out_of_time(i == 0 ? time_limit_us : max_time_us));
+        };
+        for (; i < initial_solutions && !stop_requested && !out_of_time(i == 0 ? time_limit_us : max_time_us); ++i) {
+            auto init_solution = solution;
+            while (keep_building() && run_operator(SearchOperator::CREATE_RANDOM_CYCLE, p, init_solution,
+                                                   [&]() { return create_random_cycle(p, init_solution, false); })) {}
+            while (keep_building() && run_operator(SearchOperator::ADD_TO_CYCLES, p, init_solution,
+                                                   [&]() { return add_to_cycles(p, init_solution); })) {};
+            auto cost = get_solution_cost(p, init_solution);
+            if (cost > best_solution_cost) {
+                best_solution_cost = cost;
+                best_solution = init_solution;
+                report_new_best();
+            }
         }
+        initial_span.set_arg("solutions", i);
     }
 
     weight_t best_neighbourhood_cost = std::numeric_limits<weight_t>::lowest();
@@ -107,22 +216,24 @@ solution_t solve_tabu_search(const Problem &p, solution_t solution, long long ma
     std::list<uint32_t> tabu_list;
     size_t iteration = 0;
 
-    while (true) {
-        if (iteration % TIME_MEASUREMENT_ITERATIONS == 0) {
-            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
-                    std::chrono::high_resolution_clock::now() - start_time);
-            if (std::chrono::duration<long long, std::micro>(elapsed).count() >= max_time_us) {
-                break;
-            }
+    TraceSpan search_span{"search"};
+    while (!stop_requested) {
+        if (options.max_iterations != 0 && iteration >= options.max_iterations) {
+            break;
+        }
+        if (iteration % TIME_MEASUREMENT_ITERATIONS == 0 && out_of_time(max_time_us)) {
+            break;
         }
         ++iteration;
-        for (size_t i = 0; i < ITERATIONS_PER_NEIGHBOURHOOD_SEARCH; ++i) {
+        for (size_t i = 0; i < iterations_per_neighbourhood_search && !stop_requested; ++i) {
             auto tabu_solution = best_neighbourhood_solution;
             auto prob = get_random_prob();
 
+            auto break_cycle = [&]() { return break_random_cycle(p, tabu_solution); };
+
             // Break cycles many times
-            break_random_cycle(p, tabu_solution);
-            while (prob < P_BREAK && break_random_cycle(p, tabu_solution)) {
+            run_operator(SearchOperator::BREAK_RANDOM_CYCLE, p, tabu_solution, break_cycle);
+            while (prob < p_break && run_operator(SearchOperator::BREAK_RANDOM_CYCLE, p, tabu_solution, break_cycle)) {
                 prob = get_random_prob();
             }
 
@@ -130,16 +241,21 @@ solution_t solve_tabu_search(const Problem &p, solution_t solution, long long ma
             while (heuristic_res) {
                 prob = get_random_prob();
                 if (prob < P_CYCLE) {
-                    heuristic_res = create_random_cycle(p, tabu_solution, get_random_prob() < RANDOM_CYCLE_ORDER_PROB);
+                    bool random_order = get_random_prob() < RANDOM_CYCLE_ORDER_PROB;
+                    heuristic_res = run_operator(SearchOperator::CREATE_RANDOM_CYCLE, p, tabu_solution,
+                                                 [&]() { return create_random_cycle(p, tabu_solution, random_order); });
                 } else if (prob < P_CYCLE + P_SHORTEN) {
-                    heuristic_res = shorten_long_cycles(p, tabu_solution);
+                    heuristic_res = run_operator(SearchOperator::SHORTEN_LONG_CYCLES, p, tabu_solution,
+                                                 [&]() { return shorten_long_cycles(p, tabu_solution); });
                 } else {
-                    heuristic_res = add_to_cycles(p, tabu_solution);
+                    heuristic_res = run_operator(SearchOperator::ADD_TO_CYCLES, p, tabu_solution,
+                                                 [&]() { return add_to_cycles(p, tabu_solution); });
                 }
             }
 
 
             auto tabu_solution_cost = get_solution_cost(p, tabu_solution);
+            ++stats.neighbourhood_probes;
 //            auto solution_hash = hash_vector(tabu_solution);
             if (tabu_solution_cost > best_neighbourhood_cost) {// && std::find(tabu_list.begin(), tabu_list.end(), solution_hash) == tabu_list.end()) {
                 best_neighbourhood_cost = tabu_solution_cost;
@@ -154,6 +270,7 @@ solution_t solve_tabu_search(const Problem &p, solution_t solution, long long ma
 #endif
             best_solution_cost = best_neighbourhood_cost;
             best_solution = best_neighbourhood_solution;
+            report_new_best();
         }
 
 //        if (tabu_list.size() > MAX_TABU_LIST_SIZE) {
@@ -164,5 +281,8 @@ solution_t solve_tabu_search(const Problem &p, solution_t solution, long long ma
 #ifdef DEBUG
     std::cout << "Final iterations: " << iteration << std::endl;
 #endif
+    search_span.set_arg("iterations", static_cast<long long>(iteration));
+    stats.iterations = iteration;
+    stats.search_time_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - stats.start_time).count();
     return best_solution;
 }
\ No newline at end of file
@@ -3,24 +3,59 @@
 #define COCONTEST_HEURISTICS_TABU_SEARCH_H
 
 #include <vector>
+#include <functional>
 #include "common_types.h"
 #include "Problem.h"
 
 /*!
- * Get the cost of the solution. Finds cycles of valid length and sums all the node in them
+ * Get the cost of the solution. Finds cycles of valid length and sums all the node in them. Runs in O(n) using the
+ * flattened successor arrays of the problem and data-parallel kernels (see simd_kernels.h)
  * @param p Problem for which the solution is found
  * @param solution Solution to the corresponding problem
  * @return
  */
 weight_t get_solution_cost(const Problem &p, const std::vector<node_idx_t> &solution);
 
+/*!
+ * Callback called every time the search finds a new best solution
+ */
+using new_best_callback_t = std::function<void(const std::vector<node_idx_t> &solution, weight_t cost)>;
+
+/*!
+ * Optional settings of the tabu search
+ */
+struct TabuSearchOptions {
+    // Called with each new incumbent (including the starting solution and the ones found during initial construction).
+    // May be empty
+    new_best_callback_t on_new_best;
+    // Subtract an instance-size dependent safety margin from the time limit. Can be turned off when every incumbent
+    // is already saved by on_new_best, so running until the very deadline loses nothing
+    bool use_time_margin = true;
+    // Stop after this many iterations even if time is left, 0 for no limit. With a seeded random engine, the search
+    // then gives the same solution on every run, no matter how fast it runs
+    size_t max_iterations = 0;
+};
+
+/*!
+ * Ask the running (or the next) solve_tabu_search to stop as soon as possible and return the best solution found so far.
+ * Only sets a flag, so it is safe to be called from a signal handler
+ */
+void request_tabu_search_stop();
+
+/*!
+ * Whether request_tabu_search_stop was called. Long phases outside of the search (e.g. the pair matching) check it too
+ */
+bool is_tabu_search_stop_requested();
+
 /*!
  * Solve the problem using tabu search
  * @param p Problem to solve
  * @param solution Initial solution
  * @param max_time_us Time limit for the function in microseconds. NOTE: the larger the input problem is the bigger deviation of run time from this value may be
+ * @param options Callbacks and time handling settings
  * @return Solution to the problem as list of successor indices for each node
  */
-std::vector<node_idx_t> solve_tabu_search(const Problem &p, std::vector<node_idx_t> solution, long long max_time_us);
+std::vector<node_idx_t> solve_tabu_search(const Problem &p, std::vector<node_idx_t> solution, long long max_time_us,
+                                          const TabuSearchOptions &options = TabuSearchOptions());
 
 #endif //COCONTEST_HEURISTICS_TABU_SEARCH_H
@@ -0,0 +1,194 @@
+#ifndef KOA_COMMON_TRACE_H
+#define KOA_COMMON_TRACE_H
+
+// Lightweight scoped-span tracer shared by the solvers. Spans are collected into per-thread buffers and written in the
+// Chrome trace event format, which can be opened in chrome://tracing or https://ui.perfetto.dev
+// Header only and C++11, as the cocontest solver has to be built with -std=c++11
+//
+// Usage:
+//     Tracer::instance().enable();
+//     {
+//         TraceSpan span{"parse"};
+//         ...
+//         span.set_arg("lines", n);
+//     }
+//     Tracer::instance().write_chrome_json("trace.json");
+//
+// When the tracer is not enabled, a span costs one check of a flag
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <cstdint>
+#include <sys/resource.h>
+
+/*!
+ * One finished span
+ */
+struct TraceEvent {
+    static const int MAX_ARGS = 4;
+
+    const char *name;
+    const char *category;
+    int64_t start_us;
+    int64_t duration_us;
+    // Peak resident set size of the process at the start and at the end of the span
+    long peak_rss_start_kb;
+    long peak_rss_end_kb;
+    int n_args;
+    const char *arg_names[MAX_ARGS];
+    long long arg_values[MAX_ARGS];
+};
+
+class Tracer {
+public:
+    static Tracer &instance() {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    void enable() {
+        enabled_.store(true, std::memory_order_relaxed);
+    }
+
+    bool enabled() const {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    // Microseconds since the tracer was created
+    int64_t now_us() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+    // Peak resident set size of the process in kB
+    static long peak_rss_kb() {
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+    }
+
+    // Add the event to the buffer of the calling thread
+    void record(const TraceEvent &event) {
+        local_buffer().events.push_back(event);
+    }
+
+    /*!
+     * Write all recorded events to a file in the Chrome trace event format. Must not run concurrently with threads
+     * that are still recording spans
+     * @return True if the file was written successfully
+     */
+    bool write_chrome_json(const std::string &filename) {
+        std::ofstream os{filename};
+        if (!os) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock{mutex_};
+        os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+        bool first = true;
+        auto separator = [&]() -> const char * {
+            const char *res = first ? "  " : ",\n  ";
+            first = false;
+            return res;
+        };
+        for (const auto &buffer: buffers_) {
+            os << separator() << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->tid
+               << ", \"args\": {\"name\": \"" << (buffer->tid == 0 ? "main" : "worker") << " " << buffer->tid << "\"}}";
+            for (const auto &e: buffer->events) {
+                os << separator() << "{\"name\": \"" << e.name << "\", \"cat\": \"" << e.category
+                   << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->tid << ", \"ts\": " << e.start_us
+                   << ", \"dur\": " << e.duration_us << ", \"args\": {\"peak_rss_kb\": " << e.peak_rss_end_kb
+                   << ", \"peak_rss_growth_kb\": " << e.peak_rss_end_kb - e.peak_rss_start_kb;
+                for (int i = 0; i < e.n_args; ++i) {
+                    os << ", \"" << e.arg_names[i] << "\": " << e.arg_values[i];
+                }
+                os << "}}";
+                // Counter track, so the memory growth is visible on the timeline
+                os << separator() << "{\"name\": \"peak_rss_kb\", \"ph\": \"C\", \"pid\": 1, \"ts\": "
+                   << e.start_us + e.duration_us << ", \"args\": {\"peak_rss_kb\": " << e.peak_rss_end_kb << "}}";
+            }
+        }
+        os << "\n]}\n";
+        return static_cast<bool>(os);
+    }
+
+private:
+    struct ThreadBuffer {
+        uint32_t tid;
+        std::vector<TraceEvent> events;
+    };
+
+    Tracer() : start_{std::chrono::steady_clock::now()} {}
+
+    // Buffers are registered under the mutex once per thread, appending events needs no synchronization
+    ThreadBuffer &local_buffer() {
+        static thread_local std::shared_ptr<ThreadBuffer> buffer;
+        if (!buffer) {
+            buffer = std::make_shared<ThreadBuffer>();
+            std::lock_guard<std::mutex> lock{mutex_};
+            buffer->tid = static_cast<uint32_t>(buffers_.size());
+            buffers_.push_back(buffer);
+        }
+        return *buffer;
+    }
+
+    std::atomic<bool> enabled_{false};
+    std::chrono::steady_clock::time_point start_;
+    std::mutex mutex_;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+};
+
+/*!
+ * Span covering the lifetime of the object. Name, category and argument names must be string literals (or outlive
+ * the tracer)
+ */
+class TraceSpan {
+public:
+    explicit TraceSpan(const char *name, const char *category = "phase") : active_{Tracer::instance().enabled()} {
+        if (!active_) {
+            return;
+        }
+        event_.name = name;
+        event_.category = category;
+        event_.n_args = 0;
+        event_.peak_rss_start_kb = Tracer::peak_rss_kb();
+        event_.start_us = Tracer::instance().now_us();
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+    // Attach a numeric argument shown with the span. At most TraceEvent::MAX_ARGS are kept
+    void set_arg(const char *name, long long value) {
+        if (!active_ || event_.n_args == TraceEvent::MAX_ARGS) {
+            return;
+        }
+        event_.arg_names[event_.n_args] = name;
+        event_.arg_values[event_.n_args] = value;
+        ++event_.n_args;
+    }
+
+    // End the span before the end of the scope
+    void finish() {
+        if (!active_) {
+            return;
+        }
+        active_ = false;
+        event_.duration_us = Tracer::instance().now_us() - event_.start_us;
+        event_.peak_rss_end_kb = Tracer::peak_rss_kb();
+        Tracer::instance().record(event_);
+    }
+
+    ~TraceSpan() {
+        finish();
+    }
+
+private:
+    bool active_;
+    TraceEvent event_;
+};
+
+#endif //KOA_COMMON_TRACE_H
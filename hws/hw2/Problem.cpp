@@ -0,0 +1,153 @@
+#include "Problem.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include "trace.h"
+
+void Problem::print_flow() const {
+    for (const auto &e: edges) {
+        if (e.f != 0) {
+            std::cout << "| " << e.from << " -> " << e.to << ", " << e.f << " |" << std::endl;
+        }
+    }
+}
+
+Problem read_extended_problem(const std::string &input_filename) {
+    TraceSpan span{"read"};
+    std::ifstream is{input_filename};
+    int C, P;
+    is >> C >> P;
+    Problem problem{C, P};
+
+    std::string line;
+    std::getline(is, line);  // Skip the first row with no numbers left
+    int l, u, p;
+    for (int i = 0; i < C; ++i) {
+        std::getline(is, line);
+        std::stringstream ss{line};
+        ss >> l >> u;
+        problem.edges.push_back(Edge{problem.s, i, l, u, 0});
+        while (ss >> p) {
+            --p;
+            int cost = 0;
+            if (ss.peek() == ':') {
+                ss.get();
+                ss >> cost;
+                problem.has_costs = problem.has_costs || cost != 0;
+            }
+            problem.edges.push_back(Edge{i, problem.product_node(p), 0, 1, 0, cost});
+        }
+    }
+
+    // Read product reviews needs
+    std::getline(is, line);
+    std::stringstream ss{line};
+    for (p = 0; p < P; ++p) {
+        int need;
+        ss >> need;
+        problem.edges.push_back(Edge{problem.product_node(p), problem.t, need, INF, 0});
+    }
+
+    span.set_arg("edges", static_cast<long long>(problem.edges.size()));
+    return problem;
+}
+
+void write_output_to_file(const std::string &output_filename, bool solved, const Problem &p) {
+    TraceSpan span{"write"};
+    std::ofstream os{output_filename};
+    if (!solved) {
+        os << -1;
+        os.close();
+        return;
+    }
+    // Edges of each customer are stored together and customers go one after another
+    int customer = 0;
+    bool first = true; // To avoid space in the end of the row
+    for (const auto &e: p.edges) {
+        if (!p.is_customer_product_edge(e)) {
+            continue;
+        }
+        while (customer < e.from) {
+            os << "\n";
+            ++customer;
+            first = true;
+        }
+        if (e.f == 1) {
+            os << (first ? "" : " ") << e.to - p.C + 1;
+            first = false;
+        }
+    }
+    while (customer < p.C - 1) {
+        os << "\n";
+        ++customer;
+    }
+}
+
+void write_output_to_file(const std::string &output_filename, bool solved,
+                          const std::vector<std::vector<int>> &assigned_products) {
+    TraceSpan span{"write"};
+    std::ofstream os{output_filename};
+    if (!solved) {
+        os << -1;
+        return;
+    }
+    for (size_t c = 0; c < assigned_products.size(); ++c) {
+        if (c != 0) {
+            os << "\n";
+        }
+        for (size_t i = 0; i < assigned_products[c].size(); ++i) {
+            os << (i == 0 ? "" : " ") << assigned_products[c][i] + 1;
+        }
+    }
+}
+
+bool read_deltas(const std::string &filename, std::vector<std::vector<AssignmentDelta>> &batches) {
+    std::ifstream is{filename};
+    if (!is) {
+        std::cerr << "Could not open deltas file " << filename << std::endl;
+        return false;
+    }
+    batches.clear();
+    batches.emplace_back();
+    std::string line;
+    int line_number = 0;
+    while (std::getline(is, line)) {
+        ++line_number;
+        std::stringstream ss{line};
+        std::string kind;
+        if (!(ss >> kind) || kind[0] == '#') {
+            continue;
+        }
+        AssignmentDelta delta;
+        bool ok;
+        if (kind == "solve") {
+            if (!batches.back().empty()) {
+                batches.emplace_back();
+            }
+            continue;
+        } else if (kind == "bounds") {
+            delta.type = AssignmentDelta::Type::BOUNDS;
+            ok = static_cast<bool>(ss >> delta.customer >> delta.l >> delta.u);
+        } else if (kind == "need") {
+            delta.type = AssignmentDelta::Type::NEED;
+            ok = static_cast<bool>(ss >> delta.product >> delta.need);
+        } else if (kind == "add" || kind == "remove") {
+            delta.type = kind == "add" ? AssignmentDelta::Type::ADD_ARC : AssignmentDelta::Type::REMOVE_ARC;
+            ok = static_cast<bool>(ss >> delta.customer >> delta.product);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            std::cerr << "Invalid delta on line " << line_number << ": " << line << std::endl;
+            return false;
+        }
+        // Numbers in the file are 1-based as in the input and output
+        --delta.customer;
+        --delta.product;
+        batches.back().push_back(delta);
+    }
+    if (batches.back().empty()) {
+        batches.pop_back();
+    }
+    return true;
+}
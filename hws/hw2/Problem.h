@@ -0,0 +1,90 @@
+#ifndef KOA_FLOWS_PROBLEM_H
+#define KOA_FLOWS_PROBLEM_H
+
+#include <vector>
+#include <string>
+#include <limits>
+
+const int INF = std::numeric_limits<int>::max();
+
+/*!
+ * Arc of the flow network with lower bound l, upper bound u, flow f and cost of a unit of flow
+ */
+struct Edge {
+    int from;
+    int to;
+    int l;
+    int u;
+    int f;
+    int cost = 0;
+};
+
+/*!
+ * Review assignment network: source -> customers [l, u], customers -> products [0, 1], products -> sink [need, INF].
+ * Nodes are numbered customers first (0..C-1), then products (C..C+P-1), then s and t
+ */
+struct Problem {
+    int C; // Number of customers
+    int P; // Number of products
+    int n;
+    int s;
+    int t;
+    // All the arcs. Arcs of one customer to products are stored in the order of the input
+    std::vector<Edge> edges;
+    bool has_costs = false; // Some customer -> product arc has a non-zero cost
+
+    Problem(int C, int P) : C{C}, P{P}, n{C + P + 2}, s{C + P}, t{C + P + 1} {}
+
+    int customer_node(int customer) const {
+        return customer;
+    }
+
+    int product_node(int product) const {
+        return C + product;
+    }
+
+    bool is_customer_product_edge(const Edge &e) const {
+        return e.from < C && e.to >= C && e.to < C + P;
+    }
+
+    void print_flow() const;
+};
+
+/*!
+ * Change of a review assignment instance. Customers and products are 0-based
+ */
+struct AssignmentDelta {
+    enum class Type {
+        BOUNDS, // New [l, u] of a customer
+        NEED, // New need of a product
+        ADD_ARC, // Customer can review the product
+        REMOVE_ARC // Customer cannot review the product anymore
+    };
+    Type type;
+    int customer = 0;
+    int product = 0;
+    int l = 0;
+    int u = 0;
+    int need = 0;
+};
+
+//! Read the problem instance from file and add 2 additional nodes in the end:
+//! s, t. A product of a customer may be written as product:cost to give the arc an integer cost
+//! \param input_filename Path to the input file in format specified in the task
+//! \return Problem instance with 2 additional nodes added in the end: s, t in this order
+Problem read_extended_problem(const std::string &input_filename);
+
+//! Write assigned products of each customer, or -1 if the problem is not solved
+void write_output_to_file(const std::string &output_filename, bool solved, const Problem &p);
+
+//! Write the given (0-based) products of each customer, or -1 if the problem is not solved
+void write_output_to_file(const std::string &output_filename, bool solved,
+                          const std::vector<std::vector<int>> &assigned_products);
+
+//! Read batches of deltas. Every line is one of "bounds c l u", "need p k", "add c p", "remove c p" with 1-based
+//! customer and product numbers, or "solve", which ends the current batch. Empty lines and lines starting with # are
+//! skipped
+//! \return False if the file cannot be read or contains an invalid line
+bool read_deltas(const std::string &filename, std::vector<std::vector<AssignmentDelta>> &batches);
+
+#endif //KOA_FLOWS_PROBLEM_H
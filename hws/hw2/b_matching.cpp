@@ -0,0 +1,616 @@
+#include "b_matching.h"
+#include <algorithm>
+#include <limits>
+#include "trace.h"
+
+BMatching::BMatching(const Problem &p)
+        : C_{p.C}, P_{p.P}, lower_(p.C, 0), upper_(p.C, 0), degree_(p.C, 0), need_(p.P, 0), cust_first_(p.C + 1, 0),
+          prod_first_(p.P + 1, 0), load_(p.C, 0), got_(p.P, 0), level_(p.C + p.P), current_(p.C + p.P),
+          queue_(p.C + p.P), customer_dirty_(p.C, 0), product_dirty_(p.P, 0) {
+    for (const auto &e: p.edges) {
+        if (e.from == p.s) {
+            lower_[e.to] = e.l;
+            upper_[e.to] = e.u;
+        } else if (e.to == p.t) {
+            need_[e.from - p.C] = e.l;
+        } else if (p.is_customer_product_edge(e)) {
+            // Customer arcs come one customer after another, in the order of the input
+            ++cust_first_[e.from + 1];
+            arc_customer_.push_back(e.from);
+            arc_product_.push_back(e.to - p.C);
+            ++prod_first_[e.to - p.C + 1];
+        }
+    }
+    for (int c = 0; c < C_; ++c) {
+        degree_[c] = cust_first_[c + 1];
+        cust_first_[c + 1] += cust_first_[c];
+    }
+    for (int q = 0; q < P_; ++q) {
+        prod_first_[q + 1] += prod_first_[q];
+    }
+    csr_arcs_ = static_cast<int>(arc_product_.size());
+    matched_.assign(csr_arcs_, 0);
+    removed_.assign(csr_arcs_, 0);
+    prod_arcs_.resize(csr_arcs_);
+    std::vector<int> next(prod_first_.begin(), prod_first_.end() - 1);
+    for (int a = 0; a < csr_arcs_; ++a) {
+        prod_arcs_[next[arc_product_[a]]++] = a;
+    }
+    for (int c = 0; c < C_; ++c) {
+        if (!customer_bounds_ok(c)) {
+            ++bad_customers_;
+        }
+    }
+}
+
+bool BMatching::solve(FlowStats *stats) {
+    TraceSpan span{"b_matching"};
+    if (structure_changed_) {
+        compact();
+    }
+    std::fill(matched_.begin(), matched_.end(), 0);
+    std::fill(load_.begin(), load_.end(), 0);
+    std::fill(got_.begin(), got_.end(), 0);
+
+    greedy_match();
+    FlowStats local_stats;
+    while (bfs_levels()) {
+        ++local_stats.phases;
+        for (int c = 0; c < C_; ++c) {
+            current_[c] = cust_first_[c];
+        }
+        for (int q = 0; q < P_; ++q) {
+            current_[C_ + q] = prod_first_[q];
+        }
+        for (int q = 0; q < P_; ++q) {
+            if (got_[q] < need_[q] && level_[C_ + q] == 0) {
+                local_stats.augmentations += augment_from(q);
+            }
+        }
+    }
+    fill_customers();
+    span.set_arg("phases", local_stats.phases);
+    span.set_arg("augmentations", local_stats.augmentations);
+    if (stats) {
+        *stats += local_stats;
+    }
+
+    // Products left without their needs are the starting point of later incremental repairs
+    for (int c: dirty_customers_) {
+        customer_dirty_[c] = 0;
+    }
+    dirty_customers_.clear();
+    for (int q: dirty_products_) {
+        product_dirty_[q] = 0;
+    }
+    dirty_products_.clear();
+    for (int q = 0; q < P_; ++q) {
+        if (got_[q] < need_[q]) {
+            mark_product(q);
+        }
+    }
+    bool feasible = bad_customers_ == 0 && dirty_products_.empty();
+    span.set_arg("feasible", feasible);
+    return feasible;
+}
+
+void BMatching::write_flow(Problem &p) const {
+    int a = 0;
+    for (auto &e: p.edges) {
+        if (e.from == p.s) {
+            e.f = load_[e.to];
+        } else if (e.to == p.t) {
+            e.f = got_[e.from - p.C];
+        } else if (p.is_customer_product_edge(e)) {
+            e.f = matched_[a++];
+        }
+    }
+}
+
+std::vector<std::vector<int>> BMatching::assigned_products() const {
+    std::vector<std::vector<int>> assigned(C_);
+    for (int c = 0; c < C_; ++c) {
+        assigned[c].reserve(load_[c]);
+        any_customer_arc(c, [&](int a) {
+            if (matched_[a]) {
+                assigned[c].push_back(arc_product_[a]);
+            }
+            return false;
+        });
+    }
+    return assigned;
+}
+
+void BMatching::greedy_match() {
+    for (int q = 0; q < P_; ++q) {
+        for (int i = prod_first_[q]; i < prod_first_[q + 1] && got_[q] < need_[q]; ++i) {
+            int a = prod_arcs_[i];
+            int c = customer_of(a);
+            if (load_[c] < upper_[c]) {
+                matched_[a] = 1;
+                ++load_[c];
+                ++got_[q];
+            }
+        }
+    }
+}
+
+bool BMatching::bfs_levels() {
+    std::fill(level_.begin(), level_.end(), -1);
+    size_t q_begin = 0, q_end = 0;
+    for (int q = 0; q < P_; ++q) {
+        if (got_[q] < need_[q]) {
+            level_[C_ + q] = 0;
+            queue_[q_end++] = C_ + q;
+        }
+    }
+    // Level of the nearest customer with spare capacity. Nodes at this level or deeper are not expanded
+    int free_level = std::numeric_limits<int>::max();
+    while (q_begin < q_end) {
+        int v = queue_[q_begin++];
+        if (level_[v] >= free_level) {
+            continue;
+        }
+        if (v >= C_) {
+            // Product: unmatched arcs lead to customers
+            const int q = v - C_;
+            for (int i = prod_first_[q]; i < prod_first_[q + 1]; ++i) {
+                int a = prod_arcs_[i];
+                int c = customer_of(a);
+                if (!matched_[a] && level_[c] == -1) {
+                    level_[c] = level_[v] + 1;
+                    if (load_[c] < upper_[c]) {
+                        free_level = std::min(free_level, level_[c]);
+                    } else {
+                        queue_[q_end++] = c;
+                    }
+                }
+            }
+        } else {
+            // Full customer: matched arcs lead back to products
+            for (int a = cust_first_[v]; a < cust_first_[v + 1]; ++a) {
+                int w = C_ + arc_product_[a];
+                if (matched_[a] && level_[w] == -1) {
+                    level_[w] = level_[v] + 1;
+                    queue_[q_end++] = w;
+                }
+            }
+        }
+    }
+    return free_level != std::numeric_limits<int>::max();
+}
+
+long long BMatching::augment_from(int p) {
+    const int start = C_ + p;
+    long long augmentations = 0;
+    while (got_[p] < need_[p]) {
+        // Iterative DFS over the level graph with current-arc pointers. Path alternates unmatched product -> customer
+        // and matched customer -> product arcs and ends at a customer with spare capacity
+        path_.clear();
+        int v = start;
+        bool found = false;
+        while (true) {
+            if (v < C_) {
+                if (load_[v] < upper_[v]) {
+                    found = true;
+                    break;
+                }
+                int &a = current_[v];
+                while (a < cust_first_[v + 1] && !(matched_[a] && level_[C_ + arc_product_[a]] == level_[v] + 1)) {
+                    ++a;
+                }
+                if (a < cust_first_[v + 1]) {
+                    path_.push_back(a);
+                    v = C_ + arc_product_[a];
+                    continue;
+                }
+            } else {
+                const int q = v - C_;
+                int &i = current_[v];
+                while (i < prod_first_[q + 1] &&
+                       !(!matched_[prod_arcs_[i]] && level_[customer_of(prod_arcs_[i])] == level_[v] + 1)) {
+                    ++i;
+                }
+                if (i < prod_first_[q + 1]) {
+                    path_.push_back(prod_arcs_[i]);
+                    v = customer_of(prod_arcs_[i]);
+                    continue;
+                }
+            }
+            // Dead end. Remove v from the level graph and retreat
+            level_[v] = -1;
+            if (path_.empty()) {
+                break;
+            }
+            int a = path_.back();
+            path_.pop_back();
+            v = v < C_ ? C_ + arc_product_[a] : customer_of(a);
+            ++current_[v];
+        }
+        if (!found) {
+            break;
+        }
+        // Flip the path: unmatched arcs become matched and the other way round
+        for (int a: path_) {
+            matched_[a] ^= 1;
+        }
+        ++got_[p];
+        ++load_[v];
+        ++augmentations;
+    }
+    return augmentations;
+}
+
+void BMatching::fill_customers() {
+    for (int c = 0; c < C_; ++c) {
+        for (int a = cust_first_[c]; a < cust_first_[c + 1] && load_[c] < upper_[c]; ++a) {
+            if (!matched_[a]) {
+                matched_[a] = 1;
+                ++load_[c];
+                ++got_[arc_product_[a]];
+            }
+        }
+    }
+}
+
+void BMatching::compact() {
+    std::vector<int> new_customer;
+    std::vector<int> new_product;
+    std::vector<char> new_matched;
+    new_customer.reserve(arc_product_.size());
+    new_product.reserve(arc_product_.size());
+    new_matched.reserve(arc_product_.size());
+    std::fill(cust_first_.begin(), cust_first_.end(), 0);
+    std::fill(prod_first_.begin(), prod_first_.end(), 0);
+    for (int c = 0; c < C_; ++c) {
+        any_customer_arc(c, [&](int a) {
+            new_customer.push_back(c);
+            new_product.push_back(arc_product_[a]);
+            new_matched.push_back(matched_[a]);
+            ++prod_first_[arc_product_[a] + 1];
+            return false;
+        });
+        cust_first_[c + 1] = static_cast<int>(new_product.size());
+    }
+    for (int q = 0; q < P_; ++q) {
+        prod_first_[q + 1] += prod_first_[q];
+    }
+    arc_customer_.swap(new_customer);
+    arc_product_.swap(new_product);
+    matched_.swap(new_matched);
+    csr_arcs_ = static_cast<int>(arc_product_.size());
+    removed_.assign(csr_arcs_, 0);
+    prod_arcs_.resize(csr_arcs_);
+    std::vector<int> next(prod_first_.begin(), prod_first_.end() - 1);
+    for (int a = 0; a < csr_arcs_; ++a) {
+        prod_arcs_[next[arc_product_[a]]++] = a;
+    }
+    cust_extra_head_.clear();
+    cust_extra_tail_.clear();
+    prod_extra_head_.clear();
+    extra_cust_next_.clear();
+    extra_prod_next_.clear();
+    structure_changed_ = false;
+}
+
+template<typename F>
+bool BMatching::any_customer_arc(int c, F f) const {
+    for (int a = cust_first_[c]; a < cust_first_[c + 1]; ++a) {
+        if (!removed_[a] && f(a)) {
+            return true;
+        }
+    }
+    if (!cust_extra_head_.empty()) {
+        for (int a = cust_extra_head_[c]; a != -1; a = extra_cust_next_[a - csr_arcs_]) {
+            if (!removed_[a] && f(a)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+template<typename F>
+bool BMatching::any_product_arc(int p, F f) const {
+    for (int i = prod_first_[p]; i < prod_first_[p + 1]; ++i) {
+        if (!removed_[prod_arcs_[i]] && f(prod_arcs_[i])) {
+            return true;
+        }
+    }
+    if (!prod_extra_head_.empty()) {
+        for (int a = prod_extra_head_[p]; a != -1; a = extra_prod_next_[a - csr_arcs_]) {
+            if (!removed_[a] && f(a)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+int BMatching::find_arc(int c, int p) const {
+    int found = -1;
+    any_customer_arc(c, [&](int a) {
+        if (arc_product_[a] == p) {
+            found = a;
+            return true;
+        }
+        return false;
+    });
+    return found;
+}
+
+void BMatching::match(int a) {
+    matched_[a] = 1;
+    ++load_[customer_of(a)];
+    ++got_[arc_product_[a]];
+}
+
+void BMatching::unmatch(int a) {
+    matched_[a] = 0;
+    --load_[customer_of(a)];
+    --got_[arc_product_[a]];
+}
+
+void BMatching::update_customer(int c, bool was_ok) {
+    bool ok = customer_bounds_ok(c);
+    if (was_ok && !ok) {
+        ++bad_customers_;
+    } else if (!was_ok && ok) {
+        --bad_customers_;
+    }
+    mark_customer(c);
+}
+
+void BMatching::mark_customer(int c) {
+    if (!customer_dirty_[c]) {
+        customer_dirty_[c] = 1;
+        dirty_customers_.push_back(c);
+    }
+}
+
+void BMatching::mark_product(int p) {
+    if (!product_dirty_[p]) {
+        product_dirty_[p] = 1;
+        dirty_products_.push_back(p);
+    }
+}
+
+void BMatching::set_customer_bounds(int c, int l, int u) {
+    bool was_ok = customer_bounds_ok(c);
+    lower_[c] = l;
+    upper_[c] = u;
+    update_customer(c, was_ok);
+}
+
+void BMatching::set_product_need(int p, int need) {
+    need_[p] = need;
+    if (got_[p] < need) {
+        mark_product(p);
+    }
+}
+
+bool BMatching::add_arc(int c, int p) {
+    if (find_arc(c, p) != -1) {
+        return false;
+    }
+    bool was_ok = customer_bounds_ok(c);
+    int a = -1;
+    // An arc removed earlier is revived in its place
+    for (int b = cust_first_[c]; b < cust_first_[c + 1]; ++b) {
+        if (removed_[b] && arc_product_[b] == p) {
+            a = b;
+            break;
+        }
+    }
+    if (a == -1 && !cust_extra_head_.empty()) {
+        for (int b = cust_extra_head_[c]; b != -1; b = extra_cust_next_[b - csr_arcs_]) {
+            if (removed_[b] && arc_product_[b] == p) {
+                a = b;
+                break;
+            }
+        }
+    }
+    if (a != -1) {
+        removed_[a] = 0;
+    } else {
+        if (cust_extra_head_.empty()) {
+            cust_extra_head_.assign(C_, -1);
+            cust_extra_tail_.assign(C_, -1);
+            prod_extra_head_.assign(P_, -1);
+        }
+        a = static_cast<int>(arc_product_.size());
+        arc_customer_.push_back(c);
+        arc_product_.push_back(p);
+        matched_.push_back(0);
+        removed_.push_back(0);
+        // Appended at the tail, so the customer keeps its arcs in the order they were added
+        extra_cust_next_.push_back(-1);
+        if (cust_extra_tail_[c] == -1) {
+            cust_extra_head_[c] = a;
+        } else {
+            extra_cust_next_[cust_extra_tail_[c] - csr_arcs_] = a;
+        }
+        cust_extra_tail_[c] = a;
+        extra_prod_next_.push_back(prod_extra_head_[p]);
+        prod_extra_head_[p] = a;
+    }
+    ++degree_[c];
+    structure_changed_ = true;
+    update_customer(c, was_ok);
+    return true;
+}
+
+bool BMatching::remove_arc(int c, int p) {
+    int a = find_arc(c, p);
+    if (a == -1) {
+        return false;
+    }
+    bool was_ok = customer_bounds_ok(c);
+    if (matched_[a]) {
+        unmatch(a);
+        if (got_[p] < need_[p]) {
+            mark_product(p);
+        }
+    }
+    removed_[a] = 1;
+    --degree_[c];
+    structure_changed_ = true;
+    update_customer(c, was_ok);
+    return true;
+}
+
+bool BMatching::apply(const AssignmentDelta &delta) {
+    const bool customer_valid = delta.customer >= 0 && delta.customer < C_;
+    const bool product_valid = delta.product >= 0 && delta.product < P_;
+    switch (delta.type) {
+        case AssignmentDelta::Type::BOUNDS:
+            if (!customer_valid) {
+                return false;
+            }
+            set_customer_bounds(delta.customer, delta.l, delta.u);
+            return true;
+        case AssignmentDelta::Type::NEED:
+            if (!product_valid) {
+                return false;
+            }
+            set_product_need(delta.product, delta.need);
+            return true;
+        case AssignmentDelta::Type::ADD_ARC:
+            if (!customer_valid || !product_valid) {
+                return false;
+            }
+            add_arc(delta.customer, delta.product);
+            return true;
+        default:
+            if (!customer_valid || !product_valid) {
+                return false;
+            }
+            remove_arc(delta.customer, delta.product);
+            return true;
+    }
+}
+
+bool BMatching::resolve(FlowStats *stats) {
+    TraceSpan span{"incremental_resolve"};
+    span.set_arg("customers", static_cast<long long>(dirty_customers_.size()));
+    span.set_arg("products", static_cast<long long>(dirty_products_.size()));
+
+    // Customers above their upper bound drop arcs, preferring products with a surplus of reviews
+    for (int c: dirty_customers_) {
+        for (int pass = 0; pass < 2 && load_[c] > upper_[c]; ++pass) {
+            any_customer_arc(c, [&](int a) {
+                int q = arc_product_[a];
+                if (matched_[a] && (pass == 1 || got_[q] > need_[q])) {
+                    unmatch(a);
+                    if (got_[q] < need_[q]) {
+                        mark_product(q);
+                    }
+                }
+                return load_[c] <= upper_[c];
+            });
+        }
+    }
+    // Then all the changed customers take free arcs up to their upper bound, which can only help the products
+    for (int c: dirty_customers_) {
+        any_customer_arc(c, [&](int a) {
+            if (load_[c] >= upper_[c]) {
+                return true;
+            }
+            if (!matched_[a]) {
+                match(a);
+            }
+            return false;
+        });
+        customer_dirty_[c] = 0;
+    }
+    dirty_customers_.clear();
+
+    long long augmentations = 0;
+    size_t kept = 0;
+    for (int q: dirty_products_) {
+        while (got_[q] < need_[q] && repair_product(q)) {
+            ++augmentations;
+        }
+        if (got_[q] < need_[q]) {
+            dirty_products_[kept++] = q;
+        } else {
+            product_dirty_[q] = 0;
+        }
+    }
+    dirty_products_.resize(kept);
+
+    if (stats) {
+        stats->augmentations += augmentations;
+    }
+    bool feasible = bad_customers_ == 0 && dirty_products_.empty();
+    span.set_arg("augmentations", augmentations);
+    span.set_arg("feasible", feasible);
+    return feasible;
+}
+
+bool BMatching::repair_product(int p) {
+    if (visit_stamp_.empty()) {
+        visit_stamp_.assign(C_ + P_, 0);
+        parent_arc_.assign(C_ + P_, -1);
+    }
+    if (++stamp_ == 0) {
+        std::fill(visit_stamp_.begin(), visit_stamp_.end(), 0);
+        stamp_ = 1;
+    }
+    // BFS over alternating paths. Only visited nodes are touched, so the cost depends on the neighbourhood of p
+    repair_queue_.clear();
+    repair_queue_.push_back(C_ + p);
+    visit_stamp_[C_ + p] = stamp_;
+    int end = -1;
+    for (size_t head = 0; head < repair_queue_.size() && end == -1; ++head) {
+        int v = repair_queue_[head];
+        if (v >= C_) {
+            any_product_arc(v - C_, [&](int a) {
+                int c = customer_of(a);
+                if (matched_[a] || visit_stamp_[c] == stamp_) {
+                    return false;
+                }
+                visit_stamp_[c] = stamp_;
+                parent_arc_[c] = a;
+                if (load_[c] < upper_[c]) {
+                    end = c;
+                    return true;
+                }
+                repair_queue_.push_back(c);
+                return false;
+            });
+        } else {
+            any_customer_arc(v, [&](int a) {
+                int w = C_ + arc_product_[a];
+                if (!matched_[a] || visit_stamp_[w] == stamp_) {
+                    return false;
+                }
+                visit_stamp_[w] = stamp_;
+                parent_arc_[w] = a;
+                if (got_[arc_product_[a]] > need_[arc_product_[a]]) {
+                    end = w;
+                    return true;
+                }
+                repair_queue_.push_back(w);
+                return false;
+            });
+        }
+    }
+    if (end == -1) {
+        return false;
+    }
+
+    // Flip the path back to p. Inner nodes keep their counts, the ends change by one
+    if (end < C_) {
+        ++load_[end];
+    } else {
+        --got_[end - C_];
+    }
+    ++got_[p];
+    for (int v = end; v != C_ + p;) {
+        int a = parent_arc_[v];
+        matched_[a] ^= 1;
+        v = v < C_ ? C_ + arc_product_[a] : customer_of(a);
+    }
+    return true;
+}
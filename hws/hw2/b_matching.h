@@ -0,0 +1,163 @@
+#ifndef KOA_FLOWS_B_MATCHING_H
+#define KOA_FLOWS_B_MATCHING_H
+
+#include <vector>
+#include "Problem.h"
+#include "max_flow.h"
+
+/*!
+ * Review assignment solved directly as a bounded bipartite b-matching, without the auxiliary circulation network.
+ * Products have no upper bound, so an assignment exists iff l <= min(u, degree) for every customer and products can
+ * get their needs with customer loads at most u. The needs are satisfied in Hopcroft-Karp phases of shortest
+ * alternating paths from products that lack reviews to customers with spare capacity. After that every customer is
+ * filled up to min(u, degree) with its unused arcs, which gives the maximum number of reviews as the max-flow
+ * formulation does.
+ *
+ * A solved matching can be changed by deltas (bounds, needs, added and removed arcs) and repaired by resolve(), which
+ * only touches the changed customers and products and searches alternating paths around them
+ */
+class BMatching {
+public:
+    explicit BMatching(const Problem &p);
+
+    /*!
+     * Find the assignment from scratch
+     * @param stats If not null, Hopcroft-Karp phases and augmenting paths are added to it
+     * @return True if an assignment respecting all the bounds exists
+     */
+    bool solve(FlowStats *stats = nullptr);
+
+    //! Set flows of all the edges of p (the problem this matching was built from) according to the assignment.
+    //! Valid only while no arcs were added or removed
+    void write_flow(Problem &p) const;
+
+    //! Products (0-based) assigned to each customer, in the order of the customer's arcs
+    std::vector<std::vector<int>> assigned_products() const;
+
+    // Incremental changes of a solved matching. They take effect in the next resolve()
+    void set_customer_bounds(int c, int l, int u);
+
+    void set_product_need(int p, int need);
+
+    //! @return False if the arc already exists
+    bool add_arc(int c, int p);
+
+    //! @return False if there is no such arc
+    bool remove_arc(int c, int p);
+
+    //! Apply a delta read from a file. Returns false if it refers to a customer or product that does not exist
+    bool apply(const AssignmentDelta &delta);
+
+    /*!
+     * Repair the assignment after the incremental changes: customers drop arcs above their new upper bound and take
+     * free arcs up to it, and every product lacking reviews gets them by an alternating path ending at a product with
+     * a surplus or at a customer with spare capacity. Products that could not be repaired are retried next time
+     * @param stats If not null, augmenting paths are added to it
+     * @return True if the current assignment respects all the bounds
+     */
+    bool resolve(FlowStats *stats = nullptr);
+
+    int customers() const {
+        return C_;
+    }
+
+    int products() const {
+        return P_;
+    }
+
+private:
+    // Greedy initial matching: every product takes customers with spare capacity in the order of its arcs
+    void greedy_match();
+
+    // Label products and customers by alternating BFS from products that lack reviews.
+    // Returns true if a customer with spare capacity is reachable
+    bool bfs_levels();
+
+    // Augment along level-increasing alternating paths from product p while it lacks reviews.
+    // Returns the number of augmentations
+    long long augment_from(int p);
+
+    // Fill every customer up to its upper bound with unused arcs
+    void fill_customers();
+
+    // Rebuild the CSR arrays without removed arcs and with the added ones
+    void compact();
+
+    // Calls f(a) for arcs of customer c (or product p) that were not removed until f returns true.
+    // Returns true if f did
+    template<typename F>
+    bool any_customer_arc(int c, F f) const;
+
+    template<typename F>
+    bool any_product_arc(int p, F f) const;
+
+    int find_arc(int c, int p) const;
+
+    void match(int a);
+
+    void unmatch(int a);
+
+    bool customer_bounds_ok(int c) const {
+        return lower_[c] <= upper_[c] && lower_[c] <= degree_[c];
+    }
+
+    void update_customer(int c, bool was_ok);
+
+    void mark_customer(int c);
+
+    void mark_product(int p);
+
+    // Alternating BFS from product p to a product with a surplus or a customer with spare capacity, flipping the path
+    bool repair_product(int p);
+
+    int customer_of(int a) const {
+        return arc_customer_[a];
+    }
+
+    int C_, P_;
+    std::vector<int> lower_; // Per customer
+    std::vector<int> upper_; // Per customer
+    std::vector<int> degree_; // Arcs of each customer
+    std::vector<int> need_; // Per product
+    int bad_customers_ = 0; // Customers with l > min(u, degree)
+
+    // Arcs of customer c are cust_first_[c]..cust_first_[c + 1] - 1, in the order of the input
+    std::vector<int> cust_first_;
+    std::vector<int> arc_product_;
+    std::vector<int> arc_customer_;
+    std::vector<char> matched_;
+    std::vector<char> removed_;
+    // Arc ids of product p are prod_arcs_[prod_first_[p]]..prod_arcs_[prod_first_[p + 1] - 1]
+    std::vector<int> prod_first_;
+    std::vector<int> prod_arcs_;
+
+    // Arcs added after the CSR was built (ids from csr_arcs_) are kept in linked lists of their customer and product
+    int csr_arcs_ = 0;
+    std::vector<int> cust_extra_head_;
+    std::vector<int> cust_extra_tail_;
+    std::vector<int> prod_extra_head_;
+    std::vector<int> extra_cust_next_;
+    std::vector<int> extra_prod_next_;
+    bool structure_changed_ = false;
+
+    std::vector<int> load_; // Matched arcs of each customer
+    std::vector<int> got_; // Matched arcs of each product
+
+    // Hopcroft-Karp working memory. Customers are nodes 0..C-1 and products C..C+P-1
+    std::vector<int> level_;
+    std::vector<int> current_;
+    std::vector<int> queue_;
+    std::vector<int> path_;
+
+    // Incremental repair state
+    std::vector<int> dirty_customers_;
+    std::vector<int> dirty_products_;
+    std::vector<char> customer_dirty_;
+    std::vector<char> product_dirty_;
+    std::vector<unsigned> visit_stamp_; // Node is visited by the current repair BFS if its stamp equals stamp_
+    unsigned stamp_ = 0;
+    std::vector<int> parent_arc_;
+    std::vector<int> repair_queue_;
+};
+
+#endif //KOA_FLOWS_B_MATCHING_H
@@ -0,0 +1,374 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <cstring>
+#include <malloc.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "instance_generator.h"
+#include "Problem.h"
+#include "max_flow.h"
+#include "flow_solver.h"
+#include "b_matching.h"
+#include "min_cost_flow.h"
+
+/*
+ * Benchmark of the review assignment engines on generated instances. Every engine solves every instance in a forked
+ * child process, so the peak resident memory reported by wait4 belongs to that run alone. Memory added by the run is
+ * the peak minus what the child had before solving, the copy of the instance included. The child checks the
+ * assignment against all the bounds and sends its results back through a pipe. The benchmark fails if an assignment
+ * breaks a bound or an engine disagrees with the known feasibility of the instance
+ */
+
+namespace {
+    const char *const ALL_ENGINES[] = {"b-matching", "edmonds-karp", "dinic", "push-relabel", "parallel-push-relabel",
+                                       "min-cost"};
+
+    struct Scenario {
+        std::string name;
+        GeneratorConfig config;
+        bool run_edmonds_karp; // Too slow on anything but small instances
+    };
+
+    struct Settings {
+        unsigned seed = 42;
+        int instances = 4; // Per scenario
+        double infeasible_fraction = 0.25;
+        bool quick = false;
+        int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        std::vector<std::string> engines;
+        std::string csv_filename;
+    };
+
+    // Written by the child process to the pipe, so it holds only plain values
+    struct RunResult {
+        bool solved = false;
+        bool valid = false;
+        double time_s = 0;
+        long long reviews = 0;
+        long long cost = 0;
+        long long start_rss_kb = 0; // Resident memory of the child before the run
+        FlowStats stats;
+        char error[128] = "";
+    };
+
+    std::vector<Scenario> get_scenarios(const Settings &settings) {
+        std::vector<Scenario> scenarios;
+        auto add = [&](const std::string &name, int customers, int products, double degree,
+                       DegreeDistribution degrees, double tightness, int max_cost, bool run_edmonds_karp) {
+            Scenario s;
+            s.name = name;
+            s.config.customers = customers;
+            s.config.products = products;
+            s.config.mean_degree = degree;
+            s.config.degrees = degrees;
+            s.config.tightness = tightness;
+            s.config.max_cost = max_cost;
+            s.run_edmonds_karp = run_edmonds_karp;
+            scenarios.push_back(s);
+        };
+        add("small_uniform", 2000, 100, 5, DegreeDistribution::UNIFORM, 0.8, 0, true);
+        add("medium_poisson_tight", 20000, 500, 8, DegreeDistribution::POISSON, 0.95, 0, false);
+        if (!settings.quick) {
+            add("medium_poisson_costs", 20000, 500, 8, DegreeDistribution::POISSON, 0.8, 100, false);
+            add("large_power_law", 200000, 5000, 6, DegreeDistribution::POWER_LAW, 0.8, 0, false);
+        }
+        return scenarios;
+    }
+
+    // Products (0-based) of each customer that have flow in the solved problem
+    std::vector<std::vector<int>> assignment_from_flow(const Problem &p) {
+        std::vector<std::vector<int>> assigned(p.C);
+        for (const auto &e: p.edges) {
+            if (p.is_customer_product_edge(e) && e.f == 1) {
+                assigned[e.from].push_back(e.to - p.C);
+            }
+        }
+        return assigned;
+    }
+
+    /*!
+     * Check that every customer reviews only its products, each at most once, and within its bounds, and that every
+     * product gets its reviews. Counts the reviews and their cost
+     * @return False with the first violation in error
+     */
+    bool check_assignment(const Problem &p, const std::vector<std::vector<int>> &assigned, RunResult &res) {
+        auto fail = [&](const std::string &message) {
+            std::strncpy(res.error, message.c_str(), sizeof(res.error) - 1);
+            return false;
+        };
+        if (static_cast<int>(assigned.size()) != p.C) {
+            return fail("wrong number of customers");
+        }
+        // arc_cost[q] is the cost of the arc from the current customer to q, valid if allowed_for[q] is the customer
+        std::vector<int> allowed_for(p.P, -1), used_by(p.P, -1), arc_cost(p.P, 0), got(p.P, 0);
+        std::vector<int> lower(p.C, 0), upper(p.C, 0), need(p.P, 0);
+        std::vector<std::vector<const Edge *>> arcs_of(p.C);
+        for (const auto &e: p.edges) {
+            if (e.from == p.s) {
+                lower[e.to] = e.l;
+                upper[e.to] = e.u;
+            } else if (e.to == p.t) {
+                need[e.from - p.C] = e.l;
+            } else if (p.is_customer_product_edge(e)) {
+                arcs_of[e.from].push_back(&e);
+            }
+        }
+        res.reviews = 0;
+        res.cost = 0;
+        for (int c = 0; c < p.C; ++c) {
+            for (const Edge *e: arcs_of[c]) {
+                allowed_for[e->to - p.C] = c;
+                arc_cost[e->to - p.C] = e->cost;
+            }
+            const int load = static_cast<int>(assigned[c].size());
+            if (load < lower[c] || load > upper[c]) {
+                return fail("customer " + std::to_string(c + 1) + " reviews " + std::to_string(load) +
+                            " products, bounds [" + std::to_string(lower[c]) + ", " + std::to_string(upper[c]) + "]");
+            }
+            for (int q: assigned[c]) {
+                if (q < 0 || q >= p.P || allowed_for[q] != c) {
+                    return fail("customer " + std::to_string(c + 1) + " cannot review product " + std::to_string(q + 1));
+                }
+                if (used_by[q] == c) {
+                    return fail("customer " + std::to_string(c + 1) + " reviews product " + std::to_string(q + 1) +
+                                " twice");
+                }
+                used_by[q] = c;
+                ++got[q];
+                res.cost += arc_cost[q];
+            }
+            res.reviews += load;
+        }
+        for (int q = 0; q < p.P; ++q) {
+            if (got[q] < need[q]) {
+                return fail("product " + std::to_string(q + 1) + " gets " + std::to_string(got[q]) + " reviews, needs " +
+                            std::to_string(need[q]));
+            }
+        }
+        return true;
+    }
+
+    // Resident memory of this process in kB
+    long long current_rss_kb() {
+        std::ifstream is{"/proc/self/statm"};
+        long long size = 0, resident = 0;
+        is >> size >> resident;
+        return resident * (sysconf(_SC_PAGESIZE) / 1024);
+    }
+
+    // Runs in the child process
+    RunResult run_engine(const std::string &engine, const Problem &instance, int threads) {
+        RunResult res;
+        // Free heap pages inherited from the parent would be reused without showing up in the peak memory
+        malloc_trim(0);
+        res.start_rss_kb = current_rss_kb();
+        Problem p = instance;
+        std::vector<std::vector<int>> assigned;
+        auto start = std::chrono::steady_clock::now();
+        if (engine == "b-matching") {
+            BMatching matching{p};
+            res.solved = matching.solve(&res.stats);
+            res.time_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (res.solved) {
+                assigned = matching.assigned_products();
+            }
+        } else {
+            if (engine == "min-cost") {
+                long long total_cost;
+                res.solved = solve_min_cost(p, total_cost, &res.stats);
+            } else {
+                MaxFlowOptions options;
+                parse_max_flow_algorithm(engine, options.algorithm);
+                options.threads = threads;
+                res.solved = solve_with_lower_bounds(p, options, &res.stats);
+            }
+            res.time_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (res.solved) {
+                assigned = assignment_from_flow(p);
+            }
+        }
+        res.valid = !res.solved || check_assignment(instance, assigned, res);
+        return res;
+    }
+
+    /*!
+     * Run the engine in a forked child
+     * @param peak_kb Peak resident memory of the child
+     * @return False if the child crashed
+     */
+    bool run_in_child(const std::string &engine, const Problem &instance, int threads, RunResult &res,
+                      long long &peak_kb) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            return false;
+        }
+        std::cout.flush();
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(fds[0]);
+            close(fds[1]);
+            return false;
+        }
+        if (pid == 0) {
+            close(fds[0]);
+            RunResult child_res = run_engine(engine, instance, threads);
+            ssize_t written = write(fds[1], &child_res, sizeof(child_res));
+            _exit(written == static_cast<ssize_t>(sizeof(child_res)) ? 0 : 1);
+        }
+        close(fds[1]);
+        size_t received = 0;
+        auto *buffer = reinterpret_cast<char *>(&res);
+        while (received < sizeof(res)) {
+            ssize_t r = read(fds[0], buffer + received, sizeof(res) - received);
+            if (r <= 0) {
+                break;
+            }
+            received += r;
+        }
+        close(fds[0]);
+        int status = 0;
+        rusage usage{};
+        wait4(pid, &status, 0, &usage);
+        peak_kb = usage.ru_maxrss;
+        return received == sizeof(res) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    void print_usage(const char *program) {
+        std::cerr << "Usage: " << program << " [options]\n"
+                  << "Options:\n"
+                  << "  --quick                   run only the small scenarios\n"
+                  << "  --seed <seed>             seed of the first instance of each scenario (default 42)\n"
+                  << "  --instances <n>           instances per scenario (default 4)\n"
+                  << "  --infeasible <f>          fraction of infeasible instances (default 0.25)\n"
+                  << "  --engines <list>          comma separated engines to run (default all): b-matching,\n"
+                  << "                            edmonds-karp, dinic, push-relabel, parallel-push-relabel, min-cost\n"
+                  << "  --threads <n>             threads of parallel-push-relabel (default all hardware threads)\n"
+                  << "  --csv <file>              write all runs as CSV" << std::endl;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    Settings settings;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--quick") {
+            settings.quick = true;
+            settings.instances = 2;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Unknown argument or missing value: " << arg << std::endl;
+            print_usage(argv[0]);
+            return -1;
+        }
+        const char *value = argv[++i];
+        if (arg == "--seed") {
+            settings.seed = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        } else if (arg == "--instances") {
+            settings.instances = std::max(1, std::atoi(value));
+        } else if (arg == "--infeasible") {
+            settings.infeasible_fraction = std::atof(value);
+        } else if (arg == "--engines") {
+            std::stringstream ss{value};
+            std::string engine;
+            while (std::getline(ss, engine, ',')) {
+                MaxFlowAlgorithm algorithm;
+                if (engine != "b-matching" && engine != "min-cost" && !parse_max_flow_algorithm(engine, algorithm)) {
+                    std::cerr << "Unknown engine: " << engine << std::endl;
+                    return -1;
+                }
+                settings.engines.push_back(engine);
+            }
+        } else if (arg == "--threads") {
+            settings.threads = std::max(1, std::atoi(value));
+        } else if (arg == "--csv") {
+            settings.csv_filename = value;
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            print_usage(argv[0]);
+            return -1;
+        }
+    }
+    if (settings.engines.empty()) {
+        settings.engines.assign(std::begin(ALL_ENGINES), std::end(ALL_ENGINES));
+    }
+    std::ofstream csv;
+    if (!settings.csv_filename.empty()) {
+        csv.open(settings.csv_filename);
+        csv << "scenario,instance,feasible,engine,result,time_ms,peak_kb,added_kb,augmentations,pushes,relabels,phases,"
+               "reviews,cost\n";
+    }
+
+    bool failed = false;
+    const int infeasible_instances = static_cast<int>(settings.instances * settings.infeasible_fraction + 0.5);
+    for (const auto &scenario: get_scenarios(settings)) {
+        for (int instance = 0; instance < settings.instances; ++instance) {
+            auto config = scenario.config;
+            config.seed = settings.seed + instance;
+            // Infeasible instances go last
+            config.feasible = instance < settings.instances - infeasible_instances;
+            const auto p = generate_instance(config);
+            std::cout << scenario.name << " #" << instance + 1 << " (" << p.C << " customers, " << p.P << " products, "
+                      << p.edges.size() - p.C - p.P << " arcs, " << degree_distribution_name(config.degrees)
+                      << " degrees, tightness " << config.tightness << (config.feasible ? ", feasible" : ", infeasible")
+                      << ")\n";
+            std::cout << "  " << std::left << std::setw(22) << "engine" << std::right << std::setw(8) << "result"
+                      << std::setw(10) << "time ms" << std::setw(9) << "peak MB" << std::setw(10) << "added MB"
+                      << std::setw(10) << "augment" << std::setw(10) << "pushes" << std::setw(10) << "relabels"
+                      << std::setw(8) << "phases" << std::setw(9) << "reviews" << std::setw(11) << "cost" << "\n";
+            for (const auto &engine: settings.engines) {
+                if (engine == "edmonds-karp" && !scenario.run_edmonds_karp) {
+                    continue;
+                }
+                RunResult res;
+                long long peak_kb = 0;
+                std::string result;
+                if (!run_in_child(engine, p, settings.threads, res, peak_kb)) {
+                    result = "CRASH";
+                } else if (!res.valid) {
+                    result = "INVALID";
+                } else if (res.solved != config.feasible) {
+                    result = "WRONG";
+                } else {
+                    result = res.solved ? "ok" : "ok -1";
+                }
+                failed = failed || (result != "ok" && result != "ok -1");
+                const long long added_kb = std::max(0LL, peak_kb - res.start_rss_kb);
+                auto flags = std::cout.flags();
+                auto precision = std::cout.precision();
+                std::cout << std::fixed << std::setprecision(1) << "  " << std::left << std::setw(22) << engine
+                          << std::right << std::setw(8) << result << std::setw(10) << res.time_s * 1000 << std::setw(9)
+                          << peak_kb / 1024.0 << std::setw(10) << added_kb / 1024.0 << std::setw(10)
+                          << res.stats.augmentations << std::setw(10) << res.stats.pushes << std::setw(10)
+                          << res.stats.relabels << std::setw(8) << res.stats.phases << std::setw(9) << res.reviews
+                          << std::setw(11) << res.cost << "\n";
+                std::cout.flags(flags);
+                std::cout.precision(precision);
+                if (!res.valid) {
+                    std::cout << "    " << res.error << "\n";
+                }
+                if (csv.is_open()) {
+                    csv << scenario.name << "," << instance + 1 << "," << config.feasible << "," << engine << ","
+                        << result << "," << res.time_s * 1000 << "," << peak_kb << "," << added_kb << ","
+                        << res.stats.augmentations << "," << res.stats.pushes << "," << res.stats.relabels << ","
+                        << res.stats.phases << "," << res.reviews << "," << res.cost << "\n";
+                }
+            }
+            std::cout << std::endl;
+        }
+    }
+    if (failed) {
+        std::cout << "Benchmark FAILED: an engine gave an invalid assignment or a wrong feasibility verdict" << std::endl;
+        return 1;
+    }
+    return 0;
+}
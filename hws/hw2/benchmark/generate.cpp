@@ -0,0 +1,71 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include "instance_generator.h"
+
+namespace {
+    void print_usage(const char *program) {
+        std::cerr << "Usage: " << program << " output_filename [options]\n"
+                  << "Options:\n"
+                  << "  --customers <n>         number of customers (default 10000)\n"
+                  << "  --products <n>          number of products (default 500)\n"
+                  << "  --degree <d>            mean number of products of a customer (default 8)\n"
+                  << "  --degrees <dist>        uniform, poisson or power-law (default poisson)\n"
+                  << "  --tightness <t>         0 gives loose bounds, 1 bounds equal to a planted assignment (default 0.8)\n"
+                  << "  --infeasible            make the product needs violate Hall's condition\n"
+                  << "  --max-cost <c>          arc costs uniform in [0, c], 0 for no costs (default 0)\n"
+                  << "  --seed <seed>           random seed (default 0)" << std::endl;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return -1;
+    }
+    GeneratorConfig config;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--infeasible") {
+            config.feasible = false;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << argv[i] << std::endl;
+            return -1;
+        }
+        const char *value = argv[++i];
+        if (arg == "--customers") {
+            config.customers = std::atoi(value);
+        } else if (arg == "--products") {
+            config.products = std::atoi(value);
+        } else if (arg == "--degree") {
+            config.mean_degree = std::atof(value);
+        } else if (arg == "--degrees") {
+            if (!parse_degree_distribution(value, config.degrees)) {
+                std::cerr << "Unknown degree distribution: " << value << std::endl;
+                return -1;
+            }
+        } else if (arg == "--tightness") {
+            config.tightness = std::atof(value);
+        } else if (arg == "--max-cost") {
+            config.max_cost = std::atoi(value);
+        } else if (arg == "--seed") {
+            config.seed = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            print_usage(argv[0]);
+            return -1;
+        }
+    }
+    if (config.customers < 1 || config.products < 1) {
+        std::cerr << "At least 1 customer and 1 product are needed" << std::endl;
+        return -1;
+    }
+    auto p = generate_instance(config);
+    if (!write_instance(p, argv[1])) {
+        std::cerr << "Could not write " << argv[1] << std::endl;
+        return -1;
+    }
+    return 0;
+}
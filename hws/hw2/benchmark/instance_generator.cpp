@@ -0,0 +1,194 @@
+#include "instance_generator.h"
+#include <random>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace {
+    int random_degree(const GeneratorConfig &config, std::mt19937 &rng) {
+        const double mean = std::max(1.0, config.mean_degree);
+        double d;
+        switch (config.degrees) {
+            case DegreeDistribution::UNIFORM: {
+                std::uniform_int_distribution<int> dist(1, std::max(1, static_cast<int>(std::lround(2 * mean)) - 1));
+                d = dist(rng);
+                break;
+            }
+            case DegreeDistribution::POWER_LAW: {
+                // Pareto with exponent 2.5 has mean 3 * x_min
+                std::uniform_real_distribution<double> unit(0, 1);
+                d = mean / 3 * std::pow(1 - unit(rng), -1 / 1.5);
+                break;
+            }
+            default: {
+                std::poisson_distribution<int> dist(mean);
+                d = dist(rng);
+                break;
+            }
+        }
+        return static_cast<int>(std::max(1.0, std::min<double>(config.products, d)));
+    }
+
+    /*
+     * Raise needs of a random group S of products above what their customers can give together, which is the sum of
+     * min(u, arcs into S) over the customers. Needs stay at most the product degrees, so only the group as a whole is
+     * infeasible
+     */
+    void violate_hall_condition(const GeneratorConfig &config, const std::vector<std::vector<int>> &products_of,
+                                std::vector<int> &lower, std::vector<int> &upper, std::vector<int> &need,
+                                std::mt19937 &rng) {
+        const int P = config.products;
+        std::vector<int> order(P);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), rng);
+        const int group_size = std::max(1, P / 100);
+        std::vector<char> in_group(P, 0);
+        for (int i = 0; i < group_size; ++i) {
+            in_group[order[i]] = 1;
+        }
+
+        std::vector<int> degree(P, 0);
+        long long group_capacity = 0, group_degree = 0;
+        int tight_customer = -1;
+        for (size_t c = 0; c < products_of.size(); ++c) {
+            int arcs_into_group = 0;
+            for (int q: products_of[c]) {
+                ++degree[q];
+                arcs_into_group += in_group[q];
+            }
+            group_capacity += std::min(upper[c], arcs_into_group);
+            group_degree += arcs_into_group;
+            if (arcs_into_group > 0 && upper[c] >= arcs_into_group) {
+                tight_customer = static_cast<int>(c);
+            }
+        }
+        if (group_degree == 0) {
+            // Nobody can review the group, a single review is too much
+            need[order[0]] = 1;
+            return;
+        }
+        if (group_degree == group_capacity) {
+            // Every customer could review all of its products in the group, so one of them gets a lower upper bound
+            int arcs_into_group = 0;
+            for (int q: products_of[tight_customer]) {
+                arcs_into_group += in_group[q];
+            }
+            upper[tight_customer] = arcs_into_group - 1;
+            lower[tight_customer] = std::min(lower[tight_customer], upper[tight_customer]);
+            --group_capacity;
+        }
+        long long remaining = group_capacity + 1;
+        for (int i = 0; i < group_size; ++i) {
+            int q = order[i];
+            need[q] = static_cast<int>(std::min<long long>(degree[q], remaining));
+            remaining -= need[q];
+        }
+    }
+}
+
+Problem generate_instance(const GeneratorConfig &config) {
+    std::mt19937 rng(config.seed);
+    const int C = config.customers;
+    const int P = config.products;
+    const double tightness = std::min(1.0, std::max(0.0, config.tightness));
+    std::uniform_int_distribution<int> random_product(0, P - 1);
+
+    // Products of each customer in random order. The planted assignment takes a prefix of them
+    std::vector<std::vector<int>> products_of(C);
+    std::vector<int> last_customer(P, -1);
+    std::vector<int> lower(C), upper(C);
+    std::vector<int> planted(P, 0);
+    for (int c = 0; c < C; ++c) {
+        const int degree = random_degree(config, rng);
+        auto &products = products_of[c];
+        while (static_cast<int>(products.size()) < degree) {
+            int q = random_product(rng);
+            if (last_customer[q] != c) {
+                last_customer[q] = c;
+                products.push_back(q);
+            }
+        }
+        const int load = std::uniform_int_distribution<int>(0, degree)(rng);
+        for (int i = 0; i < load; ++i) {
+            ++planted[products[i]];
+        }
+        lower[c] = static_cast<int>(std::lround(tightness * load));
+        upper[c] = load + static_cast<int>(std::lround((1 - tightness) * (degree - load)));
+    }
+    std::vector<int> need(P);
+    for (int q = 0; q < P; ++q) {
+        need[q] = static_cast<int>(std::lround(tightness * planted[q]));
+    }
+    if (!config.feasible) {
+        violate_hall_condition(config, products_of, lower, upper, need, rng);
+    }
+
+    // Edges in the same order as read_extended_problem creates them
+    Problem p{C, P};
+    std::uniform_int_distribution<int> random_cost(0, std::max(0, config.max_cost));
+    for (int c = 0; c < C; ++c) {
+        p.edges.push_back(Edge{p.s, c, lower[c], upper[c], 0});
+        for (int q: products_of[c]) {
+            int cost = config.max_cost > 0 ? random_cost(rng) : 0;
+            p.has_costs = p.has_costs || cost != 0;
+            p.edges.push_back(Edge{c, p.product_node(q), 0, 1, 0, cost});
+        }
+    }
+    for (int q = 0; q < P; ++q) {
+        p.edges.push_back(Edge{p.product_node(q), p.t, need[q], INF, 0});
+    }
+    return p;
+}
+
+bool write_instance(const Problem &p, const std::string &filename) {
+    std::ofstream os{filename};
+    if (!os) {
+        return false;
+    }
+    os << p.C << " " << p.P;
+    std::vector<int> need(p.P, 0);
+    for (const auto &e: p.edges) {
+        if (e.from == p.s) {
+            os << "\n" << e.l << " " << e.u;
+        } else if (p.is_customer_product_edge(e)) {
+            os << " " << e.to - p.C + 1;
+            if (p.has_costs) {
+                os << ":" << e.cost;
+            }
+        } else if (e.to == p.t) {
+            need[e.from - p.C] = e.l;
+        }
+    }
+    os << "\n";
+    for (int q = 0; q < p.P; ++q) {
+        os << (q == 0 ? "" : " ") << need[q];
+    }
+    os << "\n";
+    return static_cast<bool>(os);
+}
+
+bool parse_degree_distribution(const std::string &name, DegreeDistribution &distribution) {
+    if (name == "uniform") {
+        distribution = DegreeDistribution::UNIFORM;
+    } else if (name == "poisson") {
+        distribution = DegreeDistribution::POISSON;
+    } else if (name == "power-law") {
+        distribution = DegreeDistribution::POWER_LAW;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char *degree_distribution_name(DegreeDistribution distribution) {
+    switch (distribution) {
+        case DegreeDistribution::UNIFORM:
+            return "uniform";
+        case DegreeDistribution::POWER_LAW:
+            return "power-law";
+        default:
+            return "poisson";
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef KOA_FLOWS_INSTANCE_GENERATOR_H
+#define KOA_FLOWS_INSTANCE_GENERATOR_H
+
+#include <string>
+#include "Problem.h"
+
+/*!
+ * Distribution of the number of products each customer can review
+ */
+enum class DegreeDistribution {
+    UNIFORM, // Uniform in [1, 2 * mean - 1]
+    POISSON, // Poisson with the given mean, at least 1
+    POWER_LAW // Pareto with exponent 2.5 and the given mean. Most customers know few products, some know very many
+};
+
+/*!
+ * Parameters of a generated review assignment instance
+ */
+struct GeneratorConfig {
+    int customers = 10000;
+    int products = 500;
+    double mean_degree = 8;
+    DegreeDistribution degrees = DegreeDistribution::POISSON;
+    // Every instance has a planted assignment. With tightness 0 customer bounds are [0, degree] and products need
+    // nothing, with tightness 1 the bounds and needs equal the planted assignment exactly
+    double tightness = 0.8;
+    // Infeasible instances get product needs that violate Hall's condition for a small group of products, while every
+    // single product and customer still looks satisfiable on its own
+    bool feasible = true;
+    // Costs of customer -> product arcs are uniform in [0, max_cost]. 0 gives an instance without costs
+    int max_cost = 0;
+    unsigned seed = 0;
+};
+
+/*!
+ * Generate a random review assignment instance. The same config always gives the same instance
+ * @param config Generator parameters
+ * @return Generated problem with s and t as read_extended_problem creates it
+ */
+Problem generate_instance(const GeneratorConfig &config);
+
+/*!
+ * Write the problem to a file in the input format of the task. Arc costs are written as product:cost if there are any
+ * @return True if the file was written successfully
+ */
+bool write_instance(const Problem &p, const std::string &filename);
+
+/*!
+ * Parse the name of degree distribution ("uniform", "poisson" or "power-law")
+ * @return True if the name is valid
+ */
+bool parse_degree_distribution(const std::string &name, DegreeDistribution &distribution);
+
+const char *degree_distribution_name(DegreeDistribution distribution);
+
+#endif //KOA_FLOWS_INSTANCE_GENERATOR_H
@@ -0,0 +1,80 @@
+#include "flow_solver.h"
+#include <vector>
+#include "residual_graph.h"
+#include "trace.h"
+
+namespace {
+    // Nodes reachable from the source over arcs with residual capacity
+    std::vector<char> reachable_from(const ResidualGraph &g, int source) {
+        std::vector<char> reached(g.n);
+        std::vector<int> queue{source};
+        reached[source] = true;
+        for (size_t head = 0; head < queue.size(); ++head) {
+            const int v = queue[head];
+            for (int a = g.first[v]; a < g.first[v + 1]; ++a) {
+                if (g.cap[a] > 0 && !reached[g.head[a]]) {
+                    reached[g.head[a]] = true;
+                    queue.push_back(g.head[a]);
+                }
+            }
+        }
+        return reached;
+    }
+}
+
+bool solve_with_lower_bounds(Problem &p, const MaxFlowOptions &options, FlowStats *stats,
+                             InfeasibilityCertificate *certificate) {
+    TraceSpan feasibility_span{"feasibility_circulation"};
+    // Extended network with s' = n and t' = n + 1. Lower bounds are moved to node balances
+    const int s_ext = p.n;
+    const int t_ext = p.n + 1;
+    ResidualGraphBuilder builder{p.n + 2};
+    std::vector<long long> balance(p.n, 0);
+    for (const auto &e: p.edges) {
+        builder.add_arc(e.from, e.to, e.u == INF ? INF : e.u - e.l);
+        balance[e.to] += e.l;
+        balance[e.from] -= e.l;
+    }
+    const int back_arc_id = builder.add_arc(p.t, p.s, INF);
+
+    // Arcs from s' and to t' are added after all the edges and t->s, so the auxiliary arc ids are a continuous range
+    long long required_flow = 0;
+    for (int v = 0; v < p.n; ++v) {
+        if (balance[v] > 0) {
+            builder.add_arc(s_ext, v, static_cast<int>(balance[v]));
+            required_flow += balance[v];
+        } else if (balance[v] < 0) {
+            builder.add_arc(v, t_ext, static_cast<int>(-balance[v]));
+        }
+    }
+    std::vector<int> arc_index;
+    auto g = builder.build(arc_index);
+
+    // If the flow does not saturate all the arcs from s' -- no feasible solution exists
+    auto feasibility_flow = max_flow(g, s_ext, t_ext, options, stats);
+    feasibility_span.set_arg("feasible", feasibility_flow == required_flow);
+    feasibility_span.finish();
+    if (feasibility_flow != required_flow) {
+        if (certificate) {
+            *certificate = certificate_from_cut(p, reachable_from(g, s_ext));
+        }
+        return false;
+    }
+
+    // Remove the auxiliary arcs together with their flow. s and t do not need to keep flow conservation
+    for (int id = back_arc_id; id < static_cast<int>(arc_index.size()); ++id) {
+        int a = arc_index[id];
+        g.cap[a] = 0;
+        g.cap[g.rev[a]] = 0;
+    }
+
+    TraceSpan max_flow_span{"max_flow"};
+    max_flow(g, p.s, p.t, options, stats);
+
+    // Flow of an edge is its lower bound plus the flow on the reverse residual arc
+    for (size_t i = 0; i < p.edges.size(); ++i) {
+        auto &e = p.edges[i];
+        e.f = e.l + g.cap[g.rev[arc_index[i]]];
+    }
+    return true;
+}
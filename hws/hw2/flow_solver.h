@@ -0,0 +1,21 @@
+#ifndef KOA_FLOWS_FLOW_SOLVER_H
+#define KOA_FLOWS_FLOW_SOLVER_H
+
+#include "Problem.h"
+#include "max_flow.h"
+#include "preflight.h"
+
+/*!
+ * Find a feasible flow respecting lower bounds and then maximize it. Both stages run on one CSR residual graph:
+ * the feasibility circulation adds arc t->s and nodes s', t' that are disconnected again before the second stage
+ * @param p Problem whose edge flows are filled in if a feasible flow exists
+ * @param options Max-flow algorithm used in both stages
+ * @param stats If not null, work counters of both stages are added to it
+ * @param certificate If not null and no feasible flow exists, filled with the violating set read off the minimum cut
+ * of the feasibility circulation
+ * @return True if a feasible flow exists
+ */
+bool solve_with_lower_bounds(Problem &p, const MaxFlowOptions &options = MaxFlowOptions(), FlowStats *stats = nullptr,
+                             InfeasibilityCertificate *certificate = nullptr);
+
+#endif //KOA_FLOWS_FLOW_SOLVER_H
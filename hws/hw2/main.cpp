@@ -1,271 +1,161 @@
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <sstream>
 #include <vector>
-#include <queue>
-#include <limits>
-
-// Global variables used throughout the whole solution. Not a good practice, but OK for such application
-int C, P;
-const int INF = std::numeric_limits<int>::max();
-
-enum VISITED {
-    NOT_VISITED = 0,
-    DIRECT = 1,
-    BACK = 2
-};
-
-struct Edge {
-    int to;
-    int l;
-    int u;
-    int f;
-};
-
-struct Problem {
-    int n;
-    int s;
-    int t;
-    // Keeping both out and in adjacent edges for each node. Not a nice solution as when updating two of them need to be updated but let it be for now
-    std::vector<std::vector<Edge>> out;
-    std::vector<std::vector<Edge>> in;
-
-    explicit Problem(int n) : n{n} {
-        out = std::vector<std::vector<Edge>>(n);
-        in = std::vector<std::vector<Edge>>(n);
-        s = n - 2;
-        t = n - 1;
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include "Problem.h"
+#include "max_flow.h"
+#include "flow_solver.h"
+#include "b_matching.h"
+#include "min_cost_flow.h"
+#include "preflight.h"
+#include "trace.h"
+
+namespace {
+    enum class Engine {
+        B_MATCHING,
+        MIN_COST,
+        MAX_FLOW
+    };
+
+    void print_usage(const char *program) {
+        std::cerr << "Usage: " << program << " input_file output_file [options]\n"
+                  << "Options:\n"
+                  << "  --engine <name>   b-matching (default), min-cost (default if the input has arc costs written\n"
+                  << "                    as product:cost) or a max-flow algorithm for the general lower-bound\n"
+                  << "                    solver: dinic, push-relabel, parallel-push-relabel or edmonds-karp\n"
+                  << "  --threads <n>     worker threads, 0 for all hardware threads. More than 1 selects\n"
+                  << "                    parallel-push-relabel unless --engine is given or the input has costs\n"
+                  << "  --deltas <file>   after solving, apply batches of changes (lines \"bounds c l u\", \"need p k\",\n"
+                  << "                    \"add c p\", \"remove c p\", batches ended by \"solve\") and repair the\n"
+                  << "                    assignment incrementally. Needs the b-matching engine\n"
+                  << "  --trace <file>    write a Chrome trace of the solver phases\n"
+                  << "  --certificate <file>  if there is no assignment, write a set of customers and products whose\n"
+                  << "                    bounds can not hold together" << std::endl;
     }
+}
 
-    void add_flow(int from, int to, int f) {
-        // Find the right edge in out edges
-        for (auto &e: out[from]) {
-            if (e.to == to) {
-                e.f += f;
-                break;
-            }
-        }
 
-        // Find the edge in the in edges
-        for (auto &e: in[to]) {
-            if (e.to == from) {
-                e.f += f;
-                break;
-            }
-        }
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        std::cerr << "Wrong number of arguments. At least 2 are needed" << std::endl;
+        print_usage(argv[0]);
+        return -1;
     }
-
-    void print_flow() const {
-        for (size_t i = 0; i < n; ++i) {
-            std::cout << "Node: " << i << ": ";
-            for (const auto &e: out[i]) {
-                if (e.f != 0) {
-                    std::cout << "| " << e.to << ", " << e.f << " |   ";
-                }
+    std::string trace_filename;
+    std::string deltas_filename;
+    std::string certificate_filename;
+    MaxFlowOptions options;
+    bool engine_given = false;
+    Engine engine = Engine::B_MATCHING;
+    for (int i = 3; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_filename = argv[++i];
+        } else if (std::strcmp(argv[i], "--certificate") == 0 && i + 1 < argc) {
+            certificate_filename = argv[++i];
+        } else if (std::strcmp(argv[i], "--deltas") == 0 && i + 1 < argc) {
+            deltas_filename = argv[++i];
+        } else if (std::strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            ++i;
+            if (std::strcmp(argv[i], "b-matching") == 0) {
+                engine = Engine::B_MATCHING;
+            } else if (std::strcmp(argv[i], "min-cost") == 0) {
+                engine = Engine::MIN_COST;
+            } else if (parse_max_flow_algorithm(argv[i], options.algorithm)) {
+                engine = Engine::MAX_FLOW;
+            } else {
+                std::cerr << "Unknown engine: " << argv[i] << std::endl;
+                return -1;
             }
-            std::cout << std::endl;
-        }
-    }
-
-    void print_upper() const {
-        for (size_t i = 0; i < n; ++i) {
-            std::cout << "Node: " << i << ": ";
-            for (const auto &e: out[i]) {
-                std::cout << "| " << e.to << ", " << e.u << " |   ";
+            engine_given = true;
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = std::stoi(argv[++i]);
+            if (options.threads <= 0) {
+                options.threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
             }
-            std::cout << std::endl;
+        } else {
+            std::cerr << "Unknown argument: " << argv[i] << std::endl;
+            print_usage(argv[0]);
+            return -1;
         }
     }
-};
-
-//! Read the problem instance from file and add 2 additional nodes in the end:
-//! s, t
-//! \param input_filename Path to the input file in format specified in the task
-//! \return Problem instance with 2 additional nodes added in the end: s, tint this order
-Problem read_extended_problem(const std::string &input_filename) {
-    std::ifstream is{input_filename};
-    is >> C >> P;
-    // Create problem and indices of additional_nodes
-    Problem problem{C + P + 2};
-
-    std::string line;
-    std::getline(is, line);  // Skip the first row with no numbers left
-    int l, u, p;
-    for (int i = 0; i < C; ++i) {
-        std::getline(is, line);
-        std::stringstream ss{line};
-        ss >> l >> u;
-        problem.out[problem.s].push_back(Edge{i, l, u, 0});
-        problem.in[i].push_back(Edge{problem.s, l, u, 0});
-        while (ss >> p) {
-            --p;
-            problem.out[i].push_back(Edge{C + p, 0, 1, 0});
-            problem.in[C + p].push_back(Edge{i, 0, 1, 0});
-        }
+    if (!deltas_filename.empty() && engine != Engine::B_MATCHING) {
+        std::cerr << "--deltas works only with the b-matching engine" << std::endl;
+        return -1;
     }
-
-    // Read product reviews needs
-    std::getline(is, line);
-    std::stringstream ss{line};
-    for (p = 0; p < P; ++p) {
-        int need;
-        ss >> need;
-        problem.out[C + p].push_back(Edge{problem.t, need, INF, 0});
-        problem.in[problem.t].push_back(Edge{C + p, need, INF, 0});
+    if (!deltas_filename.empty() && !certificate_filename.empty()) {
+        std::cerr << "--certificate does not work with --deltas" << std::endl;
+        return -1;
     }
-
-    return problem;
-}
-
-void write_output_to_file(const std::string &output_filename, bool solved, const Problem &p) {
-    std::ofstream os{output_filename};
-    if (!solved) {
-        os << -1;
-        os.close();
-        return;
+    std::vector<std::vector<AssignmentDelta>> delta_batches;
+    if (!deltas_filename.empty() && !read_deltas(deltas_filename, delta_batches)) {
+        return -1;
     }
-    for (int i = 0; i < C; ++i) {
-        bool first = true; // To avoid space in the end of the row
-        for (const auto &e: p.out[i]) {
-            if (e.f == 1) {
-                os << (first ? "" : " ") << e.to - C + 1;
-                first = false;
-            }
-        }
-        if (i != C - 1) os << "\n";
+    if (!trace_filename.empty()) {
+        Tracer::instance().enable();
     }
-}
 
-//! Solve the problem using Edmonds Karp algorithm
-//! \param p A valid initial solution, for which values of f will be assigned
-void solve_edmonds_karp(Problem &p) {
-    while (true) {
-
-        // Run the BFS while filling predecessors
-        std::vector<int> pred(static_cast<size_t>(p.n));
-        std::vector<VISITED> visited(static_cast<size_t>(p.n));
-        std::queue<std::pair<int, int>> q;
-        visited[p.s] = DIRECT;
-        q.emplace(p.s, INF);
-        int augmenting_flow = 0;
-
-        while (!q.empty()) {
-//            auto [v, possible_flow] = q.front();
-            auto v = q.front().first;
-            auto possible_flow = q.front().second;
-            if (v == p.t) {
-                augmenting_flow = possible_flow;
-                break;
-            }
-            q.pop();
-            // Go through outcoming edges
-            for (const auto &to: p.out[v]) {
-                if (visited[to.to] || to.f == to.u) {
-                    continue;
-                }
-                visited[to.to] = DIRECT;
-                q.emplace(to.to, std::min(possible_flow, to.u - to.f));
-                pred[to.to] = v;
-            }
-
-            // Go through incoming edges
-            for (const auto &to: p.in[v]) {
-                if (visited[to.to] || to.f == to.l) {
-                    continue;
-                }
-                visited[to.to] = BACK;
-                q.emplace(to.to, std::min(possible_flow, to.f - to.l));
-                pred[to.to] = v;
-            }
-        }
-
-        // Stop when there is no augmenting path found
-        if (visited[p.t] == NOT_VISITED) {
-            break;
-        }
-
-        // Back propagate through the path and update the flow along it
-        auto v = p.t;
-        while (v != p.s) {
-            auto prev = pred[v];
-            if (visited[v] == DIRECT) {
-                p.add_flow(prev, v, augmenting_flow);
-            } else {
-                p.add_flow(v, prev, -augmenting_flow);
-            }
-            v = prev;
+    auto problem = read_extended_problem(argv[1]);
+    // Without --engine, costs choose the engine before threads do, as any other engine would ignore them
+    if (!engine_given && deltas_filename.empty()) {
+        if (problem.has_costs) {
+            engine = Engine::MIN_COST;
+        } else if (options.threads > 1) {
+            options.algorithm = MaxFlowAlgorithm::PARALLEL_PUSH_RELABEL;
+            engine = Engine::MAX_FLOW;
         }
     }
-}
-
-
-bool solve_with_lower_bounds(Problem &p) {
-    Problem extended_problem{p.n + 2};
-    // Copy all the edges from the original problem but replace flow bounds
-    for (size_t i = 0; i < p.n; ++i) {
-        for (const auto &e: p.out[i]) {
-            extended_problem.out[i].push_back(Edge{e.to, 0, e.u - e.l, 0});
-        }
-        for (const auto &e: p.in[i]) {
-            extended_problem.in[i].push_back(Edge{e.to, 0, e.u - e.l, 0});
-        }
+    if (problem.has_costs && engine != Engine::MIN_COST) {
+        std::cerr << "Warning: arc costs are ignored by this engine" << std::endl;
     }
-
-    // Add an edge from t to s
-    extended_problem.out[p.t].push_back(Edge{p.s, 0, INF, 0});
-    extended_problem.in[p.s].push_back(Edge{p.t, 0, INF, 0});
-
-    // Add edges from s' and t' to nodes
-    for (size_t i = 0; i < p.n; ++i) {
-        int l_v = 0;
-        for (const auto &e: p.in[i]) {
-            l_v += e.l;
-        }
-        for (const auto &e: p.out[i]) {
-            l_v -= e.l;
-        }
-        if (l_v > 0) {
-            extended_problem.out[extended_problem.s].push_back(Edge{static_cast<int>(i), 0, l_v, 0});
-            extended_problem.in[i].push_back(Edge{extended_problem.s, 0, l_v, 0});
-        } else if (l_v < 0) {
-            extended_problem.out[i].push_back(Edge{extended_problem.t, 0, -l_v, 0});
-            extended_problem.in[extended_problem.t].push_back(Edge{static_cast<int>(i), 0, -l_v, 0});
-        }
+    if (options.threads > 1 && (engine != Engine::MAX_FLOW ||
+                                options.algorithm != MaxFlowAlgorithm::PARALLEL_PUSH_RELABEL)) {
+        std::cerr << "Warning: --threads is used only by parallel-push-relabel" << std::endl;
     }
-
-    solve_edmonds_karp(extended_problem);
-
-    // If the flow does not saturate all the out nodes from the source -- no feasible solution exists
-    for (const auto &e: extended_problem.out[extended_problem.s]) {
-        if (e.f != e.u) {
-            return false;
-        }
+    bool solved;
+    InfeasibilityCertificate certificate;
+    bool has_certificate = false;
+    // Deltas may still make an infeasible instance feasible, so it is screened only when there are none
+    if (delta_batches.empty() && preflight_infeasible(problem, &certificate)) {
+        solved = false;
+        has_certificate = true;
+        write_output_to_file(argv[2], solved, problem);
+    } else if (engine == Engine::B_MATCHING) {
+        BMatching matching{problem};
+        solved = matching.solve();
+        for (const auto &batch: delta_batches) {
+            for (const auto &delta: batch) {
+                if (!matching.apply(delta)) {
+                    std::cerr << "Delta refers to a customer or product that does not exist" << std::endl;
+                    return -1;
+                }
+            }
+            solved = matching.resolve();
+        }
+        write_output_to_file(argv[2], solved, matching.assigned_products());
+    } else if (engine == Engine::MIN_COST) {
+        long long total_cost;
+        solved = solve_min_cost(problem, total_cost);
+        write_output_to_file(argv[2], solved, problem);
+    } else {
+        solved = solve_with_lower_bounds(problem, options, nullptr, &certificate);
+        has_certificate = !solved;
+        write_output_to_file(argv[2], solved, problem);
     }
-
-    // Update the initial feasible solution to the original problem
-    for (size_t i = 0; i < p.n; ++i) {
-        for (size_t j = 0; j < p.out[i].size(); ++j) {
-            p.out[i][j].f = p.out[i][j].l + extended_problem.out[i][j].f;
+    if (!solved && !certificate_filename.empty()) {
+        if (!has_certificate) {
+            // Other engines do not keep a residual graph, so the cut comes from the circulation on a copy
+            auto copy = problem;
+            solve_with_lower_bounds(copy, options, nullptr, &certificate);
         }
-        for (size_t j = 0; j < p.in[i].size(); ++j) {
-            p.in[i][j].f = p.in[i][j].l + extended_problem.in[i][j].f;
+        if (!write_certificate(certificate_filename, certificate)) {
+            std::cerr << "Could not write certificate to " << certificate_filename << std::endl;
         }
     }
 
-    solve_edmonds_karp(p);
-    return true;
-}
-
-
-int main(int argc, char *argv[]) {
-    if (argc != 3) {
-        std::cerr << "Wrong number of arguments. Must be 2";
-        return -1;
+    if (!trace_filename.empty() && !Tracer::instance().write_chrome_json(trace_filename)) {
+        std::cerr << "Could not write trace to " << trace_filename << std::endl;
     }
-    auto problem = read_extended_problem(argv[1]);
-    auto solved = solve_with_lower_bounds(problem);
-    write_output_to_file(argv[2], solved, problem);
-
     return 0;
 }
@@ -0,0 +1,401 @@
+#include "max_flow.h"
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include "parallel_push_relabel.h"
+#include "trace.h"
+
+FlowStats &FlowStats::operator+=(const FlowStats &other) {
+    augmentations += other.augmentations;
+    phases += other.phases;
+    pushes += other.pushes;
+    relabels += other.relabels;
+    global_relabels += other.global_relabels;
+    gaps += other.gaps;
+    return *this;
+}
+
+namespace {
+    const int INF_CAP = std::numeric_limits<int>::max();
+
+    long long edmonds_karp(ResidualGraph &g, int s, int t, FlowStats &stats) {
+        TraceSpan span{"edmonds_karp", "max_flow"};
+        // Buffers are allocated once for all the augmentations
+        std::vector<int> pred_arc(g.n);
+        std::vector<int> queue(g.n);
+        long long flow = 0;
+        while (true) {
+            std::fill(pred_arc.begin(), pred_arc.end(), -1);
+            size_t q_begin = 0, q_end = 0;
+            queue[q_end++] = s;
+            pred_arc[s] = -2;
+            while (q_begin < q_end && pred_arc[t] == -1) {
+                int v = queue[q_begin++];
+                for (int a = g.first[v]; a < g.first[v + 1]; ++a) {
+                    int w = g.head[a];
+                    if (g.cap[a] > 0 && pred_arc[w] == -1) {
+                        pred_arc[w] = a;
+                        queue[q_end++] = w;
+                    }
+                }
+            }
+            if (pred_arc[t] == -1) {
+                break;
+            }
+            int bottleneck = INF_CAP;
+            for (int v = t; v != s; v = g.tail(pred_arc[v])) {
+                bottleneck = std::min(bottleneck, g.cap[pred_arc[v]]);
+            }
+            for (int v = t; v != s; v = g.tail(pred_arc[v])) {
+                g.push(pred_arc[v], bottleneck);
+            }
+            flow += bottleneck;
+            ++stats.augmentations;
+        }
+        span.set_arg("augmentations", stats.augmentations);
+        return flow;
+    }
+
+    // BFS from s over arcs with residual capacity. Returns true if t is reachable
+    bool dinic_levels(const ResidualGraph &g, int s, int t, std::vector<int> &level, std::vector<int> &queue) {
+        std::fill(level.begin(), level.end(), -1);
+        size_t q_begin = 0, q_end = 0;
+        queue[q_end++] = s;
+        level[s] = 0;
+        while (q_begin < q_end) {
+            int v = queue[q_begin++];
+            for (int a = g.first[v]; a < g.first[v + 1]; ++a) {
+                int w = g.head[a];
+                if (g.cap[a] > 0 && level[w] == -1) {
+                    level[w] = level[v] + 1;
+                    queue[q_end++] = w;
+                }
+            }
+        }
+        return level[t] != -1;
+    }
+
+    long long dinic(ResidualGraph &g, int s, int t, FlowStats &stats) {
+        TraceSpan span{"dinic", "max_flow"};
+        std::vector<int> level(g.n);
+        std::vector<int> queue(g.n);
+        std::vector<int> current(g.n);
+        std::vector<int> path; // Arcs of the current DFS path
+        long long flow = 0;
+
+        while (dinic_levels(g, s, t, level, queue)) {
+            ++stats.phases;
+            std::copy(g.first.begin(), g.first.end() - 1, current.begin());
+            // Iterative DFS with current-arc pointers, so long paths do not overflow the stack
+            path.clear();
+            int v = s;
+            while (true) {
+                if (v == t) {
+                    int bottleneck = INF_CAP;
+                    for (int a: path) {
+                        bottleneck = std::min(bottleneck, g.cap[a]);
+                    }
+                    // Push and continue from the tail of the first saturated arc
+                    size_t first_saturated = path.size();
+                    for (size_t i = 0; i < path.size(); ++i) {
+                        g.push(path[i], bottleneck);
+                        if (g.cap[path[i]] == 0 && first_saturated == path.size()) {
+                            first_saturated = i;
+                        }
+                    }
+                    flow += bottleneck;
+                    ++stats.augmentations;
+                    v = g.tail(path[first_saturated]);
+                    path.resize(first_saturated);
+                    continue;
+                }
+                int &a = current[v];
+                while (a < g.first[v + 1] && (g.cap[a] == 0 || level[g.head[a]] != level[v] + 1)) {
+                    ++a;
+                }
+                if (a < g.first[v + 1]) {
+                    path.push_back(a);
+                    v = g.head[a];
+                    continue;
+                }
+                // Dead end. Remove v from the level graph and retreat
+                level[v] = -1;
+                if (v == s) {
+                    break;
+                }
+                int back = path.back();
+                path.pop_back();
+                v = g.tail(back);
+                ++current[v];
+            }
+        }
+        span.set_arg("phases", stats.phases);
+        span.set_arg("augmentations", stats.augmentations);
+        return flow;
+    }
+
+    /*!
+     * Highest-label push-relabel in two phases. The first phase computes a maximum preflow: labels are distances to t
+     * and nodes that reach label n can no longer send anything to t, so they are left alone. The second phase turns
+     * the preflow into a flow by running the same discharging with distances to s, returning the remaining excess.
+     * All nodes below label n are kept in per-label lists, so an emptied label (gap) lifts every node above it to n
+     */
+    class PushRelabel {
+    public:
+        PushRelabel(ResidualGraph &g, int s, int t, FlowStats &stats)
+                : g_{g}, s_{s}, t_{t}, n_{g.n}, stats_{stats}, excess_(g.n, 0), height_(g.n, 0), current_(g.n),
+                  buckets_(g.n), queue_(g.n), level_head_(g.n, -1), level_next_(g.n), level_prev_(g.n) {}
+
+        long long run() {
+            // Saturate all arcs leaving s
+            for (int a = g_.first[s_]; a < g_.first[s_ + 1]; ++a) {
+                int f = g_.cap[a];
+                if (f > 0) {
+                    excess_[g_.head[a]] += f;
+                    excess_[s_] -= f;
+                    g_.push(a, f);
+                    ++stats_.pushes;
+                }
+            }
+            root_ = t_;
+            discharge_all();
+            root_ = s_;
+            discharge_all();
+            return excess_[t_];
+        }
+
+    private:
+        // Global relabel runs once relabels scanned GLOBAL_RELABEL_NODE_WORK * n + m / 2 arcs. Every relabel
+        // counts RELABEL_WORK on top of the scanned arcs
+        static constexpr long long GLOBAL_RELABEL_NODE_WORK = 6;
+        static constexpr long long RELABEL_WORK = 12;
+
+        void discharge_all() {
+            global_relabel();
+            while (max_bucket_ >= 0) {
+                if (buckets_[max_bucket_].empty()) {
+                    --max_bucket_;
+                    continue;
+                }
+                int v = buckets_[max_bucket_].back();
+                buckets_[max_bucket_].pop_back();
+                // Node may be in a stale bucket after its height changed during a global relabel
+                if (excess_[v] == 0 || height_[v] != max_bucket_) {
+                    continue;
+                }
+                discharge(v);
+                if (work_since_global_ > GLOBAL_RELABEL_NODE_WORK * n_ + static_cast<long long>(g_.head.size()) / 2) {
+                    global_relabel();
+                }
+            }
+        }
+
+        void activate(int v) {
+            if (v != s_ && v != t_ && height_[v] < n_) {
+                buckets_[height_[v]].push_back(v);
+                max_bucket_ = std::max(max_bucket_, height_[v]);
+            }
+        }
+
+        void discharge(int v) {
+            while (excess_[v] > 0) {
+                int &a = current_[v];
+                if (a == g_.first[v + 1]) {
+                    relabel(v);
+                    if (height_[v] >= n_) {
+                        return;
+                    }
+                    continue;
+                }
+                int w = g_.head[a];
+                if (g_.cap[a] > 0 && height_[v] == height_[w] + 1) {
+                    int f = static_cast<int>(std::min<long long>(excess_[v], g_.cap[a]));
+                    g_.push(a, f);
+                    excess_[v] -= f;
+                    if (excess_[w] == 0) {
+                        activate(w);
+                    }
+                    excess_[w] += f;
+                    ++stats_.pushes;
+                } else {
+                    ++a;
+                }
+            }
+        }
+
+        void level_insert(int v) {
+            int h = height_[v];
+            level_prev_[v] = -1;
+            level_next_[v] = level_head_[h];
+            if (level_head_[h] != -1) {
+                level_prev_[level_head_[h]] = v;
+            }
+            level_head_[h] = v;
+            max_level_ = std::max(max_level_, h);
+        }
+
+        void level_remove(int v) {
+            if (level_prev_[v] != -1) {
+                level_next_[level_prev_[v]] = level_next_[v];
+            } else {
+                level_head_[height_[v]] = level_next_[v];
+            }
+            if (level_next_[v] != -1) {
+                level_prev_[level_next_[v]] = level_prev_[v];
+            }
+        }
+
+        void relabel(int v) {
+            ++stats_.relabels;
+            const int old_height = height_[v];
+            level_remove(v);
+            if (level_head_[old_height] == -1) {
+                // Gap: nodes above old_height cannot reach the root anymore
+                for (int h = old_height + 1; h <= max_level_; ++h) {
+                    for (int u = level_head_[h]; u != -1; u = level_next_[u]) {
+                        height_[u] = n_;
+                    }
+                    level_head_[h] = -1;
+                }
+                max_level_ = old_height - 1;
+                height_[v] = n_;
+                ++stats_.gaps;
+                return;
+            }
+            int min_height = n_ - 1;
+            for (int a = g_.first[v]; a < g_.first[v + 1]; ++a) {
+                if (g_.cap[a] > 0) {
+                    min_height = std::min(min_height, height_[g_.head[a]]);
+                }
+            }
+            height_[v] = min_height + 1;
+            current_[v] = g_.first[v];
+            if (height_[v] < n_) {
+                level_insert(v);
+            }
+            work_since_global_ += RELABEL_WORK + g_.first[v + 1] - g_.first[v];
+        }
+
+        // Exact distances to the root of the current phase by reverse BFS over residual arcs. Other nodes get n
+        void global_relabel() {
+            ++stats_.global_relabels;
+            work_since_global_ = 0;
+            std::fill(height_.begin(), height_.end(), UNLABELED);
+            // The other terminal is never entered
+            height_[root_ == t_ ? s_ : t_] = n_;
+            size_t q_begin = 0, q_end = 0;
+            queue_[q_end++] = root_;
+            height_[root_] = 0;
+            while (q_begin < q_end) {
+                int w = queue_[q_begin++];
+                for (int a = g_.first[w]; a < g_.first[w + 1]; ++a) {
+                    int v = g_.head[a];
+                    if (g_.cap[g_.rev[a]] > 0 && height_[v] == UNLABELED) {
+                        height_[v] = height_[w] + 1;
+                        queue_[q_end++] = v;
+                    }
+                }
+            }
+            std::fill(level_head_.begin(), level_head_.end(), -1);
+            max_level_ = 0;
+            for (int v = 0; v < n_; ++v) {
+                if (height_[v] == UNLABELED) {
+                    height_[v] = n_;
+                }
+                if (height_[v] < n_) {
+                    level_insert(v);
+                }
+                current_[v] = g_.first[v];
+            }
+            for (auto &b: buckets_) {
+                b.clear();
+            }
+            max_bucket_ = -1;
+            for (int v = 0; v < n_; ++v) {
+                if (excess_[v] > 0) {
+                    activate(v);
+                }
+            }
+        }
+
+        static const int UNLABELED = -1;
+
+        ResidualGraph &g_;
+        int s_, t_, n_;
+        FlowStats &stats_;
+        int root_ = -1; // t in the first phase, s in the second one
+        std::vector<long long> excess_;
+        std::vector<int> height_;
+        std::vector<int> current_;
+        std::vector<std::vector<int>> buckets_; // Active nodes by height
+        std::vector<int> queue_;
+        int max_bucket_ = -1;
+        long long work_since_global_ = 0;
+        // Doubly linked lists of all the nodes by label, for the gap heuristic
+        std::vector<int> level_head_;
+        std::vector<int> level_next_;
+        std::vector<int> level_prev_;
+        int max_level_ = 0;
+    };
+
+    long long push_relabel(ResidualGraph &g, int s, int t, FlowStats &stats) {
+        TraceSpan span{"push_relabel", "max_flow"};
+        auto flow = PushRelabel{g, s, t, stats}.run();
+        span.set_arg("pushes", stats.pushes);
+        span.set_arg("relabels", stats.relabels);
+        span.set_arg("global_relabels", stats.global_relabels);
+        span.set_arg("gaps", stats.gaps);
+        return flow;
+    }
+}
+
+long long max_flow(ResidualGraph &g, int s, int t, const MaxFlowOptions &options, FlowStats *stats) {
+    FlowStats local_stats;
+    long long flow;
+    switch (options.algorithm) {
+        case MaxFlowAlgorithm::EDMONDS_KARP:
+            flow = edmonds_karp(g, s, t, local_stats);
+            break;
+        case MaxFlowAlgorithm::PUSH_RELABEL:
+            flow = push_relabel(g, s, t, local_stats);
+            break;
+        case MaxFlowAlgorithm::PARALLEL_PUSH_RELABEL:
+            flow = parallel_push_relabel(g, s, t, options.threads, local_stats);
+            break;
+        default:
+            flow = dinic(g, s, t, local_stats);
+            break;
+    }
+    if (stats) {
+        *stats += local_stats;
+    }
+    return flow;
+}
+
+bool parse_max_flow_algorithm(const std::string &name, MaxFlowAlgorithm &algorithm) {
+    if (name == "edmonds-karp") {
+        algorithm = MaxFlowAlgorithm::EDMONDS_KARP;
+    } else if (name == "dinic") {
+        algorithm = MaxFlowAlgorithm::DINIC;
+    } else if (name == "push-relabel") {
+        algorithm = MaxFlowAlgorithm::PUSH_RELABEL;
+    } else if (name == "parallel-push-relabel") {
+        algorithm = MaxFlowAlgorithm::PARALLEL_PUSH_RELABEL;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char *max_flow_algorithm_name(MaxFlowAlgorithm algorithm) {
+    switch (algorithm) {
+        case MaxFlowAlgorithm::EDMONDS_KARP:
+            return "edmonds-karp";
+        case MaxFlowAlgorithm::PUSH_RELABEL:
+            return "push-relabel";
+        case MaxFlowAlgorithm::PARALLEL_PUSH_RELABEL:
+            return "parallel-push-relabel";
+        default:
+            return "dinic";
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef KOA_FLOWS_MAX_FLOW_H
+#define KOA_FLOWS_MAX_FLOW_H
+
+#include <string>
+#include "residual_graph.h"
+
+enum class MaxFlowAlgorithm {
+    EDMONDS_KARP, // One BFS augmenting path at a time. Kept as a reference
+    DINIC, // Blocking flows in BFS level graphs
+    PUSH_RELABEL, // Highest-label push-relabel with global relabeling and the gap heuristic
+    PARALLEL_PUSH_RELABEL // Lock-free multi-threaded push-relabel
+};
+
+/*!
+ * Max-flow algorithm together with its settings
+ */
+struct MaxFlowOptions {
+    MaxFlowAlgorithm algorithm = MaxFlowAlgorithm::DINIC;
+    int threads = 1; // Worker threads of the parallel algorithm
+};
+
+/*!
+ * Counters of the work done by max-flow algorithms
+ */
+struct FlowStats {
+    long long augmentations = 0; // Augmenting paths (Edmonds-Karp, Dinic)
+    long long phases = 0; // BFS phases (Dinic) or worklist rounds (parallel push-relabel)
+    long long pushes = 0;
+    long long relabels = 0;
+    long long global_relabels = 0;
+    long long gaps = 0; // Gap heuristic applications (push-relabel)
+
+    FlowStats &operator+=(const FlowStats &other);
+};
+
+/*!
+ * Find a maximum flow from s to t on top of the flow already present in the residual graph
+ * @param g Residual graph that is updated with the found flow
+ * @param stats If not null, work counters are added to it
+ * @return Value of the added flow
+ */
+long long max_flow(ResidualGraph &g, int s, int t, const MaxFlowOptions &options, FlowStats *stats = nullptr);
+
+/*!
+ * Parse algorithm name: "edmonds-karp", "dinic", "push-relabel" or "parallel-push-relabel"
+ * @return True if the name is valid
+ */
+bool parse_max_flow_algorithm(const std::string &name, MaxFlowAlgorithm &algorithm);
+
+const char *max_flow_algorithm_name(MaxFlowAlgorithm algorithm);
+
+#endif //KOA_FLOWS_MAX_FLOW_H
@@ -0,0 +1,280 @@
+#include "min_cost_flow.h"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+#include "residual_graph.h"
+#include "trace.h"
+
+namespace {
+    // Eps is divided by this factor between refines
+    const long long SCALING_FACTOR = 8;
+
+    /*!
+     * Goldberg-Tarjan cost scaling on a residual graph holding a feasible circulation. Reduced cost of arc a = (v, w)
+     * is cost[a] + price[v] - price[w] and the arcs with negative reduced cost are admissible
+     */
+    class CostScaling {
+    public:
+        CostScaling(ResidualGraph &g, FlowStats &stats)
+                : g_{g}, n_{g.n}, stats_{stats}, cost_(g.cost.size()), price_(g.n, 0), excess_(g.n, 0),
+                  current_(g.n), queue_(g.n), queued_(g.n, 0), dist_(g.n), scanned_(g.n), buckets_(g.n + 1) {
+            // Costs are multiplied by n + 1, so a circulation that is 1-optimal for them is optimal for the original
+            for (size_t a = 0; a < cost_.size(); ++a) {
+                cost_[a] = static_cast<long long>(g.cost[a]) * (n_ + 1);
+                max_cost_ = std::max(max_cost_, std::llabs(cost_[a]));
+            }
+        }
+
+        //! Refine the circulation with eps decreasing by SCALING_FACTOR down to 1, which makes it optimal
+        void run() {
+            long long eps = max_cost_;
+            while (eps > 1) {
+                eps = std::max(1LL, eps / SCALING_FACTOR);
+                refine(eps);
+                ++stats_.phases;
+            }
+        }
+
+    private:
+        long long reduced_cost(int v, int a) const {
+            return cost_[a] + price_[v] - price_[g_.head[a]];
+        }
+
+        // Turn the circulation, which is (eps * SCALING_FACTOR)-optimal, into an eps-optimal one by push-relabel
+        void refine(long long eps) {
+            eps_ = eps;
+            // Saturating the admissible arcs makes the circulation 0-optimal for the current prices, but leaves
+            // excesses and deficits
+            for (int v = 0; v < n_; ++v) {
+                for (int a = g_.first[v]; a < g_.first[v + 1]; ++a) {
+                    if (g_.cap[a] > 0 && reduced_cost(v, a) < 0) {
+                        int delta = g_.cap[a];
+                        g_.push(a, delta);
+                        excess_[v] -= delta;
+                        excess_[g_.head[a]] += delta;
+                    }
+                }
+            }
+            q_begin_ = q_end_ = 0;
+            for (int v = 0; v < n_; ++v) {
+                if (excess_[v] > 0) {
+                    enqueue(v);
+                }
+            }
+            price_update();
+            while (q_begin_ != q_end_) {
+                int v = queue_[q_begin_];
+                q_begin_ = q_begin_ + 1 == queue_.size() ? 0 : q_begin_ + 1;
+                queued_[v] = 0;
+                discharge(v);
+                if (work_since_update_ > PRICE_UPDATE_NODE_WORK * n_ + static_cast<long long>(g_.head.size()) / 2) {
+                    price_update();
+                }
+            }
+        }
+
+        /*!
+         * Global price update, the cost scaling analogue of a global relabel. Distances to the nodes with a deficit are
+         * found by Dial's algorithm over reversed residual arcs, where an arc of reduced cost rc is
+         * floor((rc + eps) / eps) long. Lowering every price by eps times the distance keeps the circulation
+         * eps-optimal and makes the shortest paths from excesses to deficits admissible. Nodes that were not scanned
+         * before all excesses were are lowered by the distance reached
+         */
+        void price_update() {
+            ++stats_.global_relabels;
+            work_since_update_ = 0;
+            std::fill(dist_.begin(), dist_.end(), n_ + 1);
+            std::fill(scanned_.begin(), scanned_.end(), 0);
+            long long remaining = 0;
+            for (int v = 0; v < n_; ++v) {
+                if (excess_[v] < 0) {
+                    dist_[v] = 0;
+                    buckets_[0].push_back(v);
+                } else if (excess_[v] > 0) {
+                    ++remaining;
+                }
+            }
+            int level = 0;
+            for (; level <= n_ && remaining > 0; ++level) {
+                auto &bucket = buckets_[level];
+                // Arcs of zero length add nodes to the bucket being scanned
+                for (size_t i = 0; i < bucket.size() && remaining > 0; ++i) {
+                    int w = bucket[i];
+                    if (scanned_[w] || dist_[w] != level) {
+                        continue;
+                    }
+                    scanned_[w] = 1;
+                    if (excess_[w] > 0) {
+                        --remaining;
+                    }
+                    for (int b = g_.first[w]; b < g_.first[w + 1]; ++b) {
+                        int v = g_.head[b];
+                        if (dist_[v] <= level) {
+                            continue;
+                        }
+                        int a = g_.rev[b];
+                        if (g_.cap[a] > 0) {
+                            long long rc = reduced_cost(v, a);
+                            long long length = rc < 0 ? 0 : rc / eps_ + 1;
+                            if (level + length < dist_[v]) {
+                                dist_[v] = static_cast<int>(level + length);
+                                buckets_[dist_[v]].push_back(v);
+                            }
+                        }
+                    }
+                }
+                if (remaining == 0) {
+                    break;
+                }
+            }
+            level = std::min(level, n_);
+            for (int v = 0; v < n_; ++v) {
+                price_[v] -= (scanned_[v] ? dist_[v] : level) * eps_;
+                current_[v] = g_.first[v];
+            }
+            for (auto &bucket: buckets_) {
+                bucket.clear();
+            }
+        }
+
+        void enqueue(int v) {
+            queued_[v] = 1;
+            queue_[q_end_] = v;
+            q_end_ = q_end_ + 1 == queue_.size() ? 0 : q_end_ + 1;
+        }
+
+        // Push the excess of v along admissible arcs, relabeling v when there are none
+        void discharge(int v) {
+            while (excess_[v] > 0) {
+                int &a = current_[v];
+                if (a == g_.first[v + 1]) {
+                    relabel(v);
+                    a = g_.first[v];
+                    continue;
+                }
+                if (g_.cap[a] > 0 && reduced_cost(v, a) < 0) {
+                    int w = g_.head[a];
+                    int delta = static_cast<int>(std::min<long long>(excess_[v], g_.cap[a]));
+                    g_.push(a, delta);
+                    excess_[v] -= delta;
+                    excess_[w] += delta;
+                    ++stats_.pushes;
+                    if (excess_[w] > 0 && !queued_[w]) {
+                        enqueue(w);
+                    }
+                } else {
+                    ++a;
+                }
+            }
+        }
+
+        // Lower the price of v as much as eps-optimality allows, which makes some residual arc admissible
+        void relabel(int v) {
+            long long best = std::numeric_limits<long long>::min();
+            for (int a = g_.first[v]; a < g_.first[v + 1]; ++a) {
+                if (g_.cap[a] > 0) {
+                    best = std::max(best, price_[g_.head[a]] - cost_[a]);
+                }
+            }
+            price_[v] = best - eps_;
+            ++stats_.relabels;
+            work_since_update_ += RELABEL_WORK + g_.first[v + 1] - g_.first[v];
+        }
+
+        // Price update runs once relabels scanned PRICE_UPDATE_NODE_WORK * n + m / 2 arcs, as the global relabel of
+        // push-relabel does
+        static constexpr long long PRICE_UPDATE_NODE_WORK = 24;
+        static constexpr long long RELABEL_WORK = 12;
+
+        ResidualGraph &g_;
+        int n_;
+        FlowStats &stats_;
+        std::vector<long long> cost_;
+        long long max_cost_ = 0;
+        long long eps_ = 0;
+        std::vector<long long> price_;
+        std::vector<long long> excess_;
+        std::vector<int> current_;
+        std::vector<int> queue_;
+        std::vector<char> queued_;
+        size_t q_begin_ = 0, q_end_ = 0;
+        long long work_since_update_ = 0;
+        std::vector<int> dist_;
+        std::vector<char> scanned_;
+        std::vector<std::vector<int>> buckets_;
+    };
+}
+
+bool solve_min_cost(Problem &p, long long &total_cost, FlowStats *stats) {
+    TraceSpan feasibility_span{"feasibility_circulation"};
+    total_cost = 0;
+    // A circulation never carries more than all the finite capacities together, so infinite ones are capped by that.
+    // Saturating an arc then cannot overflow
+    long long finite_total = 0;
+    for (const auto &e: p.edges) {
+        if (e.u != INF) {
+            finite_total += e.u;
+        }
+    }
+    const int cap_limit = static_cast<int>(std::min<long long>(finite_total, INF / 4));
+    // Feasible circulation found as in solve_with_lower_bounds with s' = n and t' = n + 1
+    const int s_ext = p.n;
+    const int t_ext = p.n + 1;
+    ResidualGraphBuilder builder{p.n + 2};
+    std::vector<long long> balance(p.n, 0);
+    for (const auto &e: p.edges) {
+        builder.add_arc(e.from, e.to, e.u == INF ? cap_limit : e.u - e.l, e.cost);
+        balance[e.to] += e.l;
+        balance[e.from] -= e.l;
+    }
+    const int back_arc_id = builder.add_arc(p.t, p.s, cap_limit, 0);
+    long long required_flow = 0;
+    for (int v = 0; v < p.n; ++v) {
+        if (balance[v] > 0) {
+            builder.add_arc(s_ext, v, static_cast<int>(balance[v]), 0);
+            required_flow += balance[v];
+        } else if (balance[v] < 0) {
+            builder.add_arc(v, t_ext, static_cast<int>(-balance[v]), 0);
+        }
+    }
+    std::vector<int> arc_index;
+    auto g = builder.build(arc_index);
+    if (g.cost.empty()) {
+        g.cost.assign(g.head.size(), 0);
+    }
+
+    FlowStats feasibility_stats;
+    auto feasibility_flow = max_flow(g, s_ext, t_ext, MaxFlowOptions(), &feasibility_stats);
+    if (stats) {
+        *stats += feasibility_stats;
+    }
+    feasibility_span.set_arg("feasible", feasibility_flow == required_flow);
+    feasibility_span.finish();
+    if (feasibility_flow != required_flow) {
+        return false;
+    }
+    // Auxiliary arcs are removed, t->s stays and closes the circulation
+    for (int id = back_arc_id + 1; id < static_cast<int>(arc_index.size()); ++id) {
+        int a = arc_index[id];
+        g.cap[a] = 0;
+        g.cap[g.rev[a]] = 0;
+    }
+
+    TraceSpan cost_span{"cost_scaling"};
+    FlowStats cost_stats;
+    CostScaling{g, cost_stats}.run();
+    if (stats) {
+        *stats += cost_stats;
+    }
+    for (size_t i = 0; i < p.edges.size(); ++i) {
+        auto &e = p.edges[i];
+        e.f = e.l + g.cap[g.rev[arc_index[i]]];
+        total_cost += static_cast<long long>(e.f) * e.cost;
+    }
+    cost_span.set_arg("refines", cost_stats.phases);
+    cost_span.set_arg("relabels", cost_stats.relabels);
+    cost_span.set_arg("price_updates", cost_stats.global_relabels);
+    cost_span.set_arg("cost", total_cost);
+    return true;
+}
@@ -0,0 +1,19 @@
+#ifndef KOA_FLOWS_MIN_COST_FLOW_H
+#define KOA_FLOWS_MIN_COST_FLOW_H
+
+#include "Problem.h"
+#include "max_flow.h"
+
+/*!
+ * Find the cheapest flow respecting lower and upper bounds, which is a min-cost circulation with arc t->s of zero
+ * cost. A feasible circulation is found first by Dinic on the network of solve_with_lower_bounds. It is then made
+ * optimal by Goldberg-Tarjan cost scaling: push-relabel refines keep the circulation eps-optimal with respect to node
+ * prices while eps decreases, and global price updates play the role of global relabels
+ * @param p Problem whose edge flows are filled in if a feasible flow exists
+ * @param total_cost Set to the cost of the found flow
+ * @param stats If not null, work of the feasibility max flow and of the refines (phases) is added to it
+ * @return True if a feasible flow exists
+ */
+bool solve_min_cost(Problem &p, long long &total_cost, FlowStats *stats = nullptr);
+
+#endif //KOA_FLOWS_MIN_COST_FLOW_H
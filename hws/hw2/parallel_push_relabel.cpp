@@ -0,0 +1,327 @@
+#include "parallel_push_relabel.h"
+#include <atomic>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "trace.h"
+
+namespace {
+    /*!
+     * Reusable thread barrier. The last arriving thread runs the completion step before the others are released
+     */
+    class Barrier {
+    public:
+        explicit Barrier(int count) : count_{count} {}
+
+        template<typename F>
+        void arrive_and_wait(F completion) {
+            std::unique_lock<std::mutex> lock{mutex_};
+            const auto generation = generation_;
+            if (++arrived_ == count_) {
+                completion();
+                arrived_ = 0;
+                ++generation_;
+                cv_.notify_all();
+            } else {
+                cv_.wait(lock, [&] { return generation != generation_; });
+            }
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        const int count_;
+        int arrived_ = 0;
+        long long generation_ = 0;
+    };
+
+    class ParallelPushRelabel {
+    public:
+        ParallelPushRelabel(ResidualGraph &g, int s, int t, int threads)
+                : g_{g}, s_{s}, t_{t}, n_{g.n}, threads_{threads}, cap_(g.cap.size()), excess_(g.n), height_(g.n),
+                  queued_(g.n), current_(g.n), next_lists_(threads), thread_stats_(threads), barrier_{threads}, root_{t} {}
+
+        long long run(FlowStats &stats) {
+            for (size_t a = 0; a < g_.cap.size(); ++a) {
+                cap_[a].store(g_.cap[a], std::memory_order_relaxed);
+            }
+            for (int v = 0; v < n_; ++v) {
+                excess_[v].store(0, std::memory_order_relaxed);
+                height_[v].store(0, std::memory_order_relaxed);
+                queued_[v].store(false, std::memory_order_relaxed);
+            }
+            // Saturate all arcs leaving s
+            for (int a = g_.first[s_]; a < g_.first[s_ + 1]; ++a) {
+                int f = cap_[a].load(std::memory_order_relaxed);
+                if (f > 0) {
+                    cap_[a].store(0, std::memory_order_relaxed);
+                    cap_[g_.rev[a]].fetch_add(f, std::memory_order_relaxed);
+                    excess_[g_.head[a]].fetch_add(f, std::memory_order_relaxed);
+                    excess_[s_].fetch_sub(f, std::memory_order_relaxed);
+                    ++stats.pushes;
+                }
+            }
+
+            std::vector<std::thread> workers;
+            for (int tid = 1; tid < threads_; ++tid) {
+                workers.emplace_back([this, tid] { worker(tid); });
+            }
+            worker(0);
+            for (auto &w: workers) {
+                w.join();
+            }
+
+            for (size_t a = 0; a < g_.cap.size(); ++a) {
+                g_.cap[a] = cap_[a].load(std::memory_order_relaxed);
+            }
+            for (const auto &thread_stats: thread_stats_) {
+                stats += thread_stats;
+            }
+            return excess_[t_].load();
+        }
+
+    private:
+        // Same global relabel frequency as in the sequential version: once relabels scanned
+        // GLOBAL_RELABEL_NODE_WORK * n + m / 2 arcs, each relabel counting RELABEL_WORK on top
+        static constexpr long long GLOBAL_RELABEL_NODE_WORK = 6;
+        static constexpr long long RELABEL_WORK = 12;
+        // Number of worklist entries taken by a thread at once
+        static constexpr size_t PICK_CHUNK = 16;
+        static const int UNLABELED = -1;
+
+        void worker(int tid) {
+            while (true) {
+                global_relabel(tid);
+                if (done_) {
+                    break;
+                }
+                if (current_list_.empty()) {
+                    // Maximum preflow is found, relabel again for returning the remaining excess to s
+                    continue;
+                }
+                do {
+                    process_round(tid);
+                    barrier_.arrive_and_wait([this] { end_round(); });
+                } while (!need_global_relabel_);
+            }
+        }
+
+        long long global_relabel_threshold() const {
+            return GLOBAL_RELABEL_NODE_WORK * n_ + static_cast<long long>(g_.head.size()) / 2;
+        }
+
+        // Enqueue v into the next round unless it is already waiting there
+        void activate(int v, std::vector<int> &next) {
+            if (v != s_ && v != t_ && !queued_[v].exchange(true)) {
+                next.push_back(v);
+            }
+        }
+
+        void process_round(int tid) {
+            auto &next = next_lists_[tid];
+            auto &stats = thread_stats_[tid];
+            while (true) {
+                size_t begin = pick_.fetch_add(PICK_CHUNK, std::memory_order_relaxed);
+                if (begin >= current_list_.size()) {
+                    return;
+                }
+                size_t end = std::min(current_list_.size(), begin + PICK_CHUNK);
+                for (size_t i = begin; i < end; ++i) {
+                    int u = current_list_[i];
+                    queued_[u].store(false);
+                    // Once enough relabels happened, postpone the rest of the round until after the global relabel
+                    if (work_since_global_.load(std::memory_order_relaxed) > global_relabel_threshold()) {
+                        if (excess_[u].load() > 0) {
+                            activate(u, next);
+                        }
+                        continue;
+                    }
+                    discharge(u, next, stats);
+                }
+            }
+        }
+
+        /*!
+         * Push from u to lower residual neighbours, starting at its current arc, and relabel u to one above its lowest
+         * residual neighbour when there is none, until the excess of u is zero. Only the thread discharging u decreases
+         * excess of u, residual capacities of arcs leaving u and changes height of u, so the values it reads are safe
+         * lower bounds even when other threads push into u concurrently
+         */
+        void discharge(int u, std::vector<int> &next, FlowStats &stats) {
+            long long relabels = 0;
+            long long work = 0;
+            const int arcs_end = g_.first[u + 1];
+            while (true) {
+                long long e = excess_[u].load();
+                int hu = height_[u].load(std::memory_order_relaxed);
+                if (e <= 0 || hu >= n_) {
+                    break;
+                }
+                int &a = current_[u];
+                while (a < arcs_end && (cap_[a].load(std::memory_order_relaxed) == 0 ||
+                                        height_[g_.head[a]].load(std::memory_order_relaxed) >= hu)) {
+                    ++a;
+                }
+                if (a < arcs_end) {
+                    int f = static_cast<int>(std::min<long long>(e, cap_[a].load(std::memory_order_relaxed)));
+                    int w = g_.head[a];
+                    cap_[a].fetch_sub(f);
+                    cap_[g_.rev[a]].fetch_add(f);
+                    excess_[u].fetch_sub(f);
+                    // Zero to positive transition: w becomes active and nobody else is going to enqueue it
+                    if (excess_[w].fetch_add(f) == 0) {
+                        activate(w, next);
+                    }
+                    ++stats.pushes;
+                    continue;
+                }
+                int min_height = n_ - 1;
+                for (int b = g_.first[u]; b < arcs_end; ++b) {
+                    if (cap_[b].load(std::memory_order_relaxed) > 0) {
+                        min_height = std::min(min_height, height_[g_.head[b]].load(std::memory_order_relaxed));
+                    }
+                }
+                height_[u].store(min_height + 1, std::memory_order_relaxed);
+                a = g_.first[u];
+                ++relabels;
+                work += RELABEL_WORK + arcs_end - g_.first[u];
+            }
+            if (relabels > 0) {
+                stats.relabels += relabels;
+                work_since_global_.fetch_add(work, std::memory_order_relaxed);
+            }
+        }
+
+        // Runs on the last thread reaching the end of a round
+        void end_round() {
+            current_list_.clear();
+            for (auto &next: next_lists_) {
+                current_list_.insert(current_list_.end(), next.begin(), next.end());
+                next.clear();
+            }
+            pick_.store(0, std::memory_order_relaxed);
+            ++thread_stats_[0].phases;
+            // An empty worklist is confirmed by a global relabel, which finds active nodes left below n by
+            // interleaved pushes and relabels working with stale heights
+            need_global_relabel_ = current_list_.empty() || work_since_global_.load() > global_relabel_threshold();
+        }
+
+        /*!
+         * Exact distances to the root of the current phase by reverse BFS over residual arcs, other nodes get n.
+         * Every thread expands its share of each BFS level. Afterwards the worklist is rebuilt from all active nodes.
+         * When it is empty, the current phase is over
+         */
+        void global_relabel(int tid) {
+            const int range_begin = static_cast<int>(static_cast<long long>(n_) * tid / threads_);
+            const int range_end = static_cast<int>(static_cast<long long>(n_) * (tid + 1) / threads_);
+            for (int v = range_begin; v < range_end; ++v) {
+                height_[v].store(UNLABELED, std::memory_order_relaxed);
+            }
+            barrier_.arrive_and_wait([this] {
+                // The other terminal is never entered
+                height_[root_ == t_ ? s_ : t_].store(n_, std::memory_order_relaxed);
+                height_[root_].store(0, std::memory_order_relaxed);
+                frontier_.assign(1, root_);
+                bfs_level_ = 0;
+                ++thread_stats_[0].global_relabels;
+            });
+
+            auto &local = next_lists_[tid];
+            while (true) {
+                local.clear();
+                for (size_t i = tid; i < frontier_.size(); i += threads_) {
+                    int w = frontier_[i];
+                    for (int a = g_.first[w]; a < g_.first[w + 1]; ++a) {
+                        int v = g_.head[a];
+                        int expected = UNLABELED;
+                        if (cap_[g_.rev[a]].load(std::memory_order_relaxed) > 0 &&
+                            height_[v].load(std::memory_order_relaxed) == UNLABELED &&
+                            height_[v].compare_exchange_strong(expected, bfs_level_ + 1, std::memory_order_relaxed)) {
+                            local.push_back(v);
+                        }
+                    }
+                }
+                barrier_.arrive_and_wait([this] { next_bfs_level(); });
+                if (frontier_.empty()) {
+                    break;
+                }
+            }
+
+            local.clear();
+            for (int v = range_begin; v < range_end; ++v) {
+                if (height_[v].load(std::memory_order_relaxed) == UNLABELED) {
+                    height_[v].store(n_, std::memory_order_relaxed);
+                }
+                bool active = v != s_ && v != t_ && excess_[v].load() > 0 &&
+                              height_[v].load(std::memory_order_relaxed) < n_;
+                queued_[v].store(active);
+                current_[v] = g_.first[v];
+                if (active) {
+                    local.push_back(v);
+                }
+            }
+            barrier_.arrive_and_wait([this] {
+                current_list_.clear();
+                for (auto &next: next_lists_) {
+                    current_list_.insert(current_list_.end(), next.begin(), next.end());
+                    next.clear();
+                }
+                pick_.store(0, std::memory_order_relaxed);
+                work_since_global_.store(0);
+                if (current_list_.empty()) {
+                    if (root_ == t_) {
+                        root_ = s_;
+                    } else {
+                        done_ = true;
+                    }
+                }
+            });
+        }
+
+        // Runs on the last thread finishing a BFS level
+        void next_bfs_level() {
+            frontier_.clear();
+            for (const auto &next: next_lists_) {
+                frontier_.insert(frontier_.end(), next.begin(), next.end());
+            }
+            ++bfs_level_;
+        }
+
+        ResidualGraph &g_;
+        const int s_, t_, n_;
+        const int threads_;
+        std::vector<std::atomic<int>> cap_;
+        std::vector<std::atomic<long long>> excess_;
+        std::vector<std::atomic<int>> height_;
+        std::vector<std::atomic<bool>> queued_; // Node is in the worklist and nobody has taken it yet
+        std::vector<int> current_; // Current arc, used only by the thread discharging the node
+        std::vector<int> current_list_;
+        std::vector<std::vector<int>> next_lists_; // Per-thread nodes for the next round or the next BFS level
+        std::vector<FlowStats> thread_stats_;
+        std::atomic<size_t> pick_{0};
+        std::atomic<long long> work_since_global_{0};
+        Barrier barrier_;
+
+        // Shared state written only in barrier completion steps. Barriers also order the accesses to current_ of
+        // a node discharged by different threads in different rounds
+        bool done_ = false;
+        bool need_global_relabel_ = false;
+        int root_; // t while the maximum preflow is searched, s while the remaining excess is returned
+        std::vector<int> frontier_;
+        int bfs_level_ = 0;
+    };
+}
+
+long long parallel_push_relabel(ResidualGraph &g, int s, int t, int threads, FlowStats &stats) {
+    TraceSpan span{"parallel_push_relabel", "max_flow"};
+    FlowStats local_stats;
+    auto flow = ParallelPushRelabel{g, s, t, std::max(threads, 1)}.run(local_stats);
+    span.set_arg("threads", threads);
+    span.set_arg("rounds", local_stats.phases);
+    span.set_arg("pushes", local_stats.pushes);
+    span.set_arg("global_relabels", local_stats.global_relabels);
+    stats += local_stats;
+    return flow;
+}
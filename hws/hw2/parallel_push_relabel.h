@@ -0,0 +1,18 @@
+#ifndef KOA_FLOWS_PARALLEL_PUSH_RELABEL_H
+#define KOA_FLOWS_PARALLEL_PUSH_RELABEL_H
+
+#include "residual_graph.h"
+#include "max_flow.h"
+
+/*!
+ * Lock-free multi-threaded push-relabel in the spirit of Hong and He. Each active node is discharged by one thread at a
+ * time, which pushes to lower residual neighbours with atomic updates of excesses and residual capacities. Nodes are
+ * processed in rounds from a shared worklist, and a parallel level-synchronous global relabel runs between rounds. As
+ * in the sequential version, a maximum preflow is found first and the remaining excess is returned to s afterwards
+ * @param g Residual graph that is updated with the found flow
+ * @param threads Number of worker threads, at least 1
+ * @return Value of the added flow
+ */
+long long parallel_push_relabel(ResidualGraph &g, int s, int t, int threads, FlowStats &stats);
+
+#endif //KOA_FLOWS_PARALLEL_PUSH_RELABEL_H
@@ -0,0 +1,174 @@
+#include "preflight.h"
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include "trace.h"
+
+namespace {
+    const char *const CUSTOMERS_REASON = "customers must give more reviews than they can";
+    const char *const PRODUCTS_REASON = "products need more reviews than they can get";
+
+    // Bounds and arcs of the problem gathered per customer and product
+    struct Bounds {
+        std::vector<long long> l, u; // Of each customer
+        std::vector<long long> need; // Of each product
+        std::vector<std::vector<int>> customer_products;
+        std::vector<std::vector<int>> product_customers; // In increasing order
+
+        explicit Bounds(const Problem &p) : l(p.C), u(p.C), need(p.P), customer_products(p.C),
+                                            product_customers(p.P) {
+            for (const auto &e: p.edges) {
+                if (e.from == p.s) {
+                    l[e.to] = e.l;
+                    u[e.to] = e.u;
+                } else if (e.to == p.t) {
+                    need[e.from - p.C] = e.l;
+                } else if (p.is_customer_product_edge(e)) {
+                    customer_products[e.from].push_back(e.to - p.C);
+                    product_customers[e.to - p.C].push_back(e.from);
+                }
+            }
+        }
+    };
+
+    // Customers of the set must give their lower bounds through their arcs to products outside of it
+    InfeasibilityCertificate customers_certificate(const Bounds &b, const std::vector<int> &customers,
+                                                   const std::vector<int> &products) {
+        InfeasibilityCertificate res{CUSTOMERS_REASON, customers, products};
+        std::vector<char> in_set(b.need.size());
+        for (int product: products) {
+            in_set[product] = true;
+        }
+        for (int c: customers) {
+            res.required += b.l[c];
+            for (int product: b.customer_products[c]) {
+                res.available += !in_set[product];
+            }
+        }
+        // Products of the set would pass any number of reviews on to the sink
+        if (!products.empty()) {
+            res.available = INF;
+        }
+        return res;
+    }
+
+    // Products of the set get reviews from customers of the set, at most u each, and through arcs from other customers
+    InfeasibilityCertificate products_certificate(const Bounds &b, const std::vector<int> &customers,
+                                                  const std::vector<int> &products) {
+        InfeasibilityCertificate res{PRODUCTS_REASON, customers, products};
+        std::vector<char> in_set(b.l.size());
+        for (int c: customers) {
+            in_set[c] = true;
+            res.available += b.u[c];
+        }
+        for (int product: products) {
+            res.required += b.need[product];
+            for (int c: b.product_customers[product]) {
+                res.available += !in_set[c];
+            }
+        }
+        return res;
+    }
+
+    bool found(InfeasibilityCertificate &&candidate, InfeasibilityCertificate *certificate, const char *check) {
+        if (candidate.required <= candidate.available) {
+            return false;
+        }
+        TraceSpan span{check};
+        span.set_arg("required", candidate.required);
+        span.set_arg("available", candidate.available);
+        if (certificate) {
+            *certificate = std::move(candidate);
+        }
+        return true;
+    }
+}
+
+bool preflight_infeasible(const Problem &p, InfeasibilityCertificate *certificate) {
+    TraceSpan span{"preflight"};
+    const Bounds b{p};
+
+    for (int c = 0; c < p.C; ++c) {
+        if (b.l[c] > b.u[c]) {
+            InfeasibilityCertificate candidate{"lower bound of the customer is above its upper bound", {c}, {}, b.l[c],
+                                               b.u[c]};
+            return found(std::move(candidate), certificate, "preflight_bounds");
+        }
+        const auto degree = static_cast<long long>(b.customer_products[c].size());
+        if (found(InfeasibilityCertificate{CUSTOMERS_REASON, {c}, {}, b.l[c], degree}, certificate,
+                  "preflight_customer_degree")) {
+            return true;
+        }
+    }
+
+    // All products together, with the customers whose upper bound is below their number of arcs
+    std::vector<int> all_products(p.P);
+    for (int product = 0; product < p.P; ++product) {
+        all_products[product] = product;
+    }
+    std::vector<int> limited_customers;
+    for (int c = 0; c < p.C; ++c) {
+        if (b.u[c] < static_cast<long long>(b.customer_products[c].size())) {
+            limited_customers.push_back(c);
+        }
+    }
+    if (found(products_certificate(b, limited_customers, all_products), certificate, "preflight_total_need")) {
+        return true;
+    }
+
+    // Products with the same customers, with the customers that can not review all of them
+    std::map<std::vector<int>, std::vector<int>> classes;
+    for (int product = 0; product < p.P; ++product) {
+        if (b.need[product] > 0) {
+            classes[b.product_customers[product]].push_back(product);
+        }
+    }
+    for (const auto &cls: classes) {
+        std::vector<int> customers;
+        for (int c: cls.first) {
+            if (b.u[c] < static_cast<long long>(cls.second.size())) {
+                customers.push_back(c);
+            }
+        }
+        if (found(products_certificate(b, customers, cls.second), certificate, "preflight_product_class")) {
+            return true;
+        }
+    }
+    return false;
+}
+
+InfeasibilityCertificate certificate_from_cut(const Problem &p, const std::vector<char> &source_side) {
+    const Bounds b{p};
+    const bool s_on_source_side = source_side[p.s];
+    // Without s and t on its side, the set of customers and products gets more lower bounds than it can pass on. With
+    // them, the other side is such a set for the swapped directions
+    std::vector<int> customers, products;
+    for (int c = 0; c < p.C; ++c) {
+        if (source_side[p.customer_node(c)] != s_on_source_side) {
+            customers.push_back(c);
+        }
+    }
+    for (int product = 0; product < p.P; ++product) {
+        if (source_side[p.product_node(product)] != s_on_source_side) {
+            products.push_back(product);
+        }
+    }
+    return s_on_source_side ? products_certificate(b, customers, products)
+                            : customers_certificate(b, customers, products);
+}
+
+bool write_certificate(const std::string &filename, const InfeasibilityCertificate &certificate) {
+    std::ofstream os{filename};
+    os << certificate.reason << "\n";
+    os << "required " << certificate.required << " available " << certificate.available << "\n";
+    os << "customers";
+    for (int c: certificate.customers) {
+        os << " " << c + 1;
+    }
+    os << "\nproducts";
+    for (int product: certificate.products) {
+        os << " " << product + 1;
+    }
+    os << "\n";
+    return static_cast<bool>(os);
+}
@@ -0,0 +1,43 @@
+#ifndef KOA_FLOWS_PREFLIGHT_H
+#define KOA_FLOWS_PREFLIGHT_H
+
+#include <string>
+#include <vector>
+#include "Problem.h"
+
+/*!
+ * Set of customers and products for which the bounds can not hold. By Hoffman's circulation theorem an assignment
+ * exists iff no set of nodes has more lower bounds on the arcs entering it than upper bounds on the arcs leaving it (or
+ * the same with the directions swapped), so such a set is a proof of infeasibility that can be checked by hand:
+ *  - customers of the set must give more reviews in total than they have arcs to products outside of it, or
+ *  - products of the set need more reviews than customers of the set can give plus arcs from the other customers
+ */
+struct InfeasibilityCertificate {
+    std::string reason;
+    std::vector<int> customers; // 0-based
+    std::vector<int> products; // 0-based
+    long long required = 0; // Reviews the set must give or get
+    long long available = 0; // Reviews the set can give or get at most
+};
+
+/*!
+ * Cheap checks run before the flow, in O(m log m): every customer has l <= u and l <= its number of arcs, all needs
+ * fit into the reviews customers can give at most, and every class of products with the same customers has needs
+ * that fit into what those customers can give to the class (Hall's condition on product neighbourhoods)
+ * @param certificate If not null and the problem is infeasible, filled with the violating set
+ * @return True if the problem is proven infeasible. False does not mean it is feasible
+ */
+bool preflight_infeasible(const Problem &p, InfeasibilityCertificate *certificate = nullptr);
+
+/*!
+ * Build the certificate from a minimum cut of the feasibility circulation
+ * @param source_side True for the nodes of p reachable from s' in the final residual graph. If s is among them, the
+ * products short of reviews are on the other side, otherwise the overloaded customers are on this one
+ */
+InfeasibilityCertificate certificate_from_cut(const Problem &p, const std::vector<char> &source_side);
+
+//! Write the certificate as the reason, "required <r> available <a>" and 1-based customers and products of the set
+//! \return True if the file was written
+bool write_certificate(const std::string &filename, const InfeasibilityCertificate &certificate);
+
+#endif //KOA_FLOWS_PREFLIGHT_H
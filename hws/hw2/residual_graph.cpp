@@ -0,0 +1,41 @@
+#include "residual_graph.h"
+
+ResidualGraph ResidualGraphBuilder::build(std::vector<int> &arc_index) const {
+    ResidualGraph g;
+    g.n = n_;
+    const auto m = static_cast<int>(from_.size());
+
+    // Counting sort of both directions of all arcs by their tail
+    g.first.assign(n_ + 1, 0);
+    for (int i = 0; i < m; ++i) {
+        ++g.first[from_[i] + 1];
+        ++g.first[to_[i] + 1];
+    }
+    for (int v = 0; v < n_; ++v) {
+        g.first[v + 1] += g.first[v];
+    }
+    std::vector<int> next(g.first.begin(), g.first.end() - 1);
+    g.head.resize(2 * m);
+    g.cap.resize(2 * m);
+    g.rev.resize(2 * m);
+    arc_index.resize(m);
+    if (has_costs_) {
+        g.cost.resize(2 * m);
+    }
+    for (int i = 0; i < m; ++i) {
+        int a = next[from_[i]]++;
+        int b = next[to_[i]]++;
+        g.head[a] = to_[i];
+        g.cap[a] = cap_[i];
+        g.rev[a] = b;
+        g.head[b] = from_[i];
+        g.cap[b] = 0;
+        g.rev[b] = a;
+        if (has_costs_) {
+            g.cost[a] = cost_[i];
+            g.cost[b] = -cost_[i];
+        }
+        arc_index[i] = a;
+    }
+    return g;
+}
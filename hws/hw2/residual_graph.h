@@ -0,0 +1,63 @@
+#ifndef KOA_FLOWS_RESIDUAL_GRAPH_H
+#define KOA_FLOWS_RESIDUAL_GRAPH_H
+
+#include <vector>
+
+/*!
+ * Residual network in compressed sparse row format. Arcs leaving node v are first[v]..first[v + 1] - 1. Every arc
+ * has a paired reverse arc rev[a], so pushing flow along an arc is an O(1) update of two residual capacities
+ */
+struct ResidualGraph {
+    int n{};
+    std::vector<int> first;
+    std::vector<int> head; // Target node of each arc
+    std::vector<int> cap; // Residual capacity of each arc
+    std::vector<int> rev; // Index of the paired reverse arc
+    std::vector<int> cost; // Cost of a unit of flow on each arc. Empty if no arc has a cost
+
+    int tail(int a) const {
+        return head[rev[a]];
+    }
+
+    void push(int a, int f) {
+        cap[a] -= f;
+        cap[rev[a]] += f;
+    }
+};
+
+/*!
+ * Collects arcs and builds the ResidualGraph from them
+ */
+class ResidualGraphBuilder {
+public:
+    explicit ResidualGraphBuilder(int n) : n_{n} {}
+
+    /*!
+     * Add an arc with capacity cap and cost of a unit of flow. The reverse arc gets capacity 0 and the opposite cost
+     * @return Id of the arc, which can be translated to an arc index in the built graph
+     */
+    int add_arc(int from, int to, int cap, int cost = 0) {
+        from_.push_back(from);
+        to_.push_back(to);
+        cap_.push_back(cap);
+        cost_.push_back(cost);
+        has_costs_ = has_costs_ || cost != 0;
+        return static_cast<int>(from_.size()) - 1;
+    }
+
+    /*!
+     * Build the graph
+     * @param arc_index Filled with the index of the forward arc in the graph for each added arc id
+     */
+    ResidualGraph build(std::vector<int> &arc_index) const;
+
+private:
+    int n_;
+    std::vector<int> from_;
+    std::vector<int> to_;
+    std::vector<int> cap_;
+    std::vector<int> cost_;
+    bool has_costs_ = false;
+};
+
+#endif //KOA_FLOWS_RESIDUAL_GRAPH_H
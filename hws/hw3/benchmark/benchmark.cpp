@@ -0,0 +1,334 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <thread>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "instance_generator.h"
+#include "problem.h"
+#include "bratley.h"
+#include "subset_dp.h"
+
+/*
+ * Benchmark of the scheduling search on generated instances with clustered releases and windows near the feasibility threshold. Every engine
+ * solves every instance in a forked child process, which is killed by an alarm after the time limit. The child checks
+ * the schedule against the release times and deadlines and sends its results with the search statistics back through
+ * a pipe. The benchmark fails if a schedule breaks a constraint, if a planted instance is reported infeasible, if the
+ * engines disagree, or if a verdict differs from an exact subset DP on instances small enough for it
+ */
+
+namespace {
+    const char *const ALL_ENGINES[] = {"sequential", "parallel", "min-cmax", "subset-dp"};
+
+    // Instances up to this size get their feasibility from the subset DP
+    const int EXACT_CHECK_MAX_N = 20;
+
+    struct scenario_t {
+        std::string name;
+        generator_config_t config;
+    };
+
+    struct settings_t {
+        unsigned seed = 42;
+        int instances = 4; // Per scenario
+        double unplanted_fraction = 0.5;
+        bool quick = false;
+        int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        unsigned time_limit = 10; // Seconds per run
+        std::vector<std::string> engines;
+        std::string csv_filename;
+    };
+
+    // Written by the child process to the pipe, so it holds only plain values
+    struct run_result_t {
+        bool solved = false;
+        bool valid = false;
+        double time_s = 0;
+        int makespan = 0;
+        search_stats_t stats;
+        char error[128] = "";
+    };
+
+    std::vector<scenario_t> get_scenarios(const settings_t &settings) {
+        std::vector<scenario_t> scenarios;
+        auto add = [&](int n, double slack, int clusters) {
+            scenario_t s;
+            s.name = "n" + std::to_string(n);
+            s.config.n = n;
+            s.config.slack = slack;
+            s.config.clusters = clusters;
+            scenarios.push_back(s);
+        };
+        add(10, 0.7, 3);
+        add(20, 0.8, 4);
+        add(30, 0.9, 6);
+        if (!settings.quick) {
+            add(40, 0.9, 6);
+            add(50, 0.8, 8);
+            add(60, 0.8, 8);
+        }
+        return scenarios;
+    }
+
+    // Feasibility by the earliest completion time of every subset of jobs, O(2^n n)
+    bool exactly_feasible(const problem_t &p) {
+        const int unreachable = std::numeric_limits<int>::max();
+        std::vector<int> completion(static_cast<size_t>(1) << p.n, unreachable);
+        completion[0] = 0;
+        for (size_t set = 0; set < completion.size(); ++set) {
+            if (completion[set] == unreachable) {
+                continue;
+            }
+            for (int j = 0; j < p.n; ++j) {
+                if (set >> j & 1) {
+                    continue;
+                }
+                int c = std::max(completion[set], p.r[j]) + p.p[j];
+                auto &next = completion[set | static_cast<size_t>(1) << j];
+                if (c <= p.d[j] && c < next) {
+                    next = c;
+                }
+            }
+        }
+        return completion.back() != unreachable;
+    }
+
+    /*!
+     * Check that the order holds every job once and that every job starts after its release and ends by its deadline
+     * @return False with the first violation in error
+     */
+    bool check_schedule(const problem_t &p, const std::vector<int> &order, run_result_t &res) {
+        auto fail = [&](const std::string &message) {
+            std::strncpy(res.error, message.c_str(), sizeof(res.error) - 1);
+            return false;
+        };
+        if (static_cast<int>(order.size()) != p.n) {
+            return fail("schedule has " + std::to_string(order.size()) + " jobs");
+        }
+        std::vector<char> seen(p.n, 0);
+        int c = 0;
+        for (int job: order) {
+            if (job < 0 || job >= p.n || seen[job]) {
+                return fail("job " + std::to_string(job + 1) + " is missing or scheduled twice");
+            }
+            seen[job] = 1;
+            c = std::max(c, p.r[job]) + p.p[job];
+            if (c > p.d[job]) {
+                return fail("job " + std::to_string(job + 1) + " ends at " + std::to_string(c) + ", deadline " +
+                            std::to_string(p.d[job]));
+            }
+        }
+        res.makespan = c;
+        return true;
+    }
+
+    // Runs in the child process
+    run_result_t run_engine(const std::string &engine, const problem_t &p, int threads) {
+        run_result_t res;
+        std::vector<int> order;
+        auto start = std::chrono::steady_clock::now();
+        if (engine == "min-cmax") {
+            order = optimize_schedule(p, objective_t::MAKESPAN, 0, &res.stats).order;
+        } else if (engine == "subset-dp") {
+            order = solve_subset_dp(p, threads);
+        } else {
+            order = solve_scheduling(p, engine == "parallel" ? threads : 1, &res.stats);
+        }
+        res.time_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        res.solved = !order.empty();
+        res.valid = !res.solved || check_schedule(p, order, res);
+        return res;
+    }
+
+    /*!
+     * Run the engine in a forked child, killed after time_limit seconds
+     * @param timed_out Set if the child was killed by the alarm
+     * @return False if the child crashed or timed out
+     */
+    bool run_in_child(const std::string &engine, const problem_t &p, int threads, unsigned time_limit,
+                      run_result_t &res, bool &timed_out) {
+        timed_out = false;
+        int fds[2];
+        if (pipe(fds) != 0) {
+            return false;
+        }
+        std::cout.flush();
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(fds[0]);
+            close(fds[1]);
+            return false;
+        }
+        if (pid == 0) {
+            close(fds[0]);
+            alarm(time_limit);
+            run_result_t child_res = run_engine(engine, p, threads);
+            ssize_t written = write(fds[1], &child_res, sizeof(child_res));
+            _exit(written == static_cast<ssize_t>(sizeof(child_res)) ? 0 : 1);
+        }
+        close(fds[1]);
+        size_t received = 0;
+        auto *buffer = reinterpret_cast<char *>(&res);
+        while (received < sizeof(res)) {
+            ssize_t r = read(fds[0], buffer + received, sizeof(res) - received);
+            if (r <= 0) {
+                break;
+            }
+            received += r;
+        }
+        close(fds[0]);
+        int status = 0;
+        waitpid(pid, &status, 0);
+        timed_out = WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM;
+        return received == sizeof(res) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    void print_usage(const char *program) {
+        std::cerr << "Usage: " << program << " [options]\n"
+                  << "Options:\n"
+                  << "  --quick                   run only the scenarios up to 30 jobs\n"
+                  << "  --seed <seed>             seed of the first instance of each scenario (default 42)\n"
+                  << "  --instances <n>           instances per scenario (default 4)\n"
+                  << "  --unplanted <f>           fraction of instances without a planted schedule (default 0.5)\n"
+                  << "  --engines <list>          comma separated engines to run (default all): sequential,\n"
+                  << "                            parallel, min-cmax, subset-dp (only up to 20 jobs)\n"
+                  << "  --threads <n>             threads of the parallel and subset-dp engines (default all)\n"
+                  << "  --time-limit <s>          seconds per run before it is killed (default 10)\n"
+                  << "  --csv <file>              write all runs as CSV" << std::endl;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    settings_t settings;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--quick") {
+            settings.quick = true;
+            settings.instances = 2;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Unknown argument or missing value: " << arg << std::endl;
+            print_usage(argv[0]);
+            return -1;
+        }
+        const char *value = argv[++i];
+        if (arg == "--seed") {
+            settings.seed = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        } else if (arg == "--instances") {
+            settings.instances = std::max(1, std::atoi(value));
+        } else if (arg == "--unplanted") {
+            settings.unplanted_fraction = std::atof(value);
+        } else if (arg == "--engines") {
+            std::stringstream ss{value};
+            std::string engine;
+            while (std::getline(ss, engine, ',')) {
+                if (std::find(std::begin(ALL_ENGINES), std::end(ALL_ENGINES), engine) == std::end(ALL_ENGINES)) {
+                    std::cerr << "Unknown engine: " << engine << std::endl;
+                    return -1;
+                }
+                settings.engines.push_back(engine);
+            }
+        } else if (arg == "--threads") {
+            settings.threads = std::max(1, std::atoi(value));
+        } else if (arg == "--time-limit") {
+            settings.time_limit = static_cast<unsigned>(std::max(1, std::atoi(value)));
+        } else if (arg == "--csv") {
+            settings.csv_filename = value;
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            print_usage(argv[0]);
+            return -1;
+        }
+    }
+    if (settings.engines.empty()) {
+        settings.engines.assign(std::begin(ALL_ENGINES), std::end(ALL_ENGINES));
+    }
+    std::ofstream csv;
+    if (!settings.csv_filename.empty()) {
+        csv.open(settings.csv_filename);
+        csv << "scenario,instance,planted,engine,result,time_ms,nodes,deadline_prunes,bound_prunes,memo_hits,"
+               "edf_prunes,gap_prunes,max_depth,makespan\n";
+    }
+
+    bool failed = false;
+    const int unplanted_instances = static_cast<int>(settings.instances * settings.unplanted_fraction + 0.5);
+    for (const auto &scenario: get_scenarios(settings)) {
+        for (int instance = 0; instance < settings.instances; ++instance) {
+            auto config = scenario.config;
+            config.seed = settings.seed + instance;
+            // Unplanted instances go last
+            config.planted = instance < settings.instances - unplanted_instances;
+            const auto p = generate_instance(config);
+            // -1 unknown, 0 infeasible, 1 feasible
+            int known = config.planted ? 1 : -1;
+            if (p.n <= EXACT_CHECK_MAX_N) {
+                known = exactly_feasible(p) ? 1 : 0;
+            }
+            std::cout << scenario.name << " #" << instance + 1 << " (" << p.n << " jobs, slack " << config.slack
+                      << ", " << config.clusters << " release clusters, "
+                      << (known < 0 ? "feasibility unknown" : known ? "feasible" : "infeasible") << ")\n";
+            std::cout << "  " << std::left << std::setw(12) << "engine" << std::right << std::setw(9) << "result"
+                      << std::setw(10) << "time ms" << std::setw(11) << "nodes" << std::setw(10) << "deadline"
+                      << std::setw(10) << "bound" << std::setw(10) << "memo" << std::setw(10) << "edf"
+                      << std::setw(10) << "gap" << std::setw(7) << "depth" << std::setw(9) << "cmax" << "\n";
+            int verdict = -1; // Of the first engine that finished
+            for (const auto &engine: settings.engines) {
+                if (engine == "subset-dp" && p.n > EXACT_CHECK_MAX_N) {
+                    continue;
+                }
+                run_result_t res;
+                bool timed_out = false;
+                std::string result;
+                if (!run_in_child(engine, p, settings.threads, settings.time_limit, res, timed_out)) {
+                    result = timed_out ? "TIMEOUT" : "CRASH";
+                } else if (!res.valid) {
+                    result = "INVALID";
+                } else if (known >= 0 && res.solved != (known == 1)) {
+                    result = "WRONG";
+                } else if (verdict >= 0 && res.solved != (verdict == 1)) {
+                    result = "DISAGREE";
+                } else {
+                    result = res.solved ? "ok" : "ok -1";
+                    verdict = res.solved;
+                }
+                failed = failed || (result != "ok" && result != "ok -1" && result != "TIMEOUT");
+                auto flags = std::cout.flags();
+                auto precision = std::cout.precision();
+                std::cout << std::fixed << std::setprecision(1) << "  " << std::left << std::setw(12) << engine
+                          << std::right << std::setw(9) << result << std::setw(10) << res.time_s * 1000
+                          << std::setw(11) << res.stats.nodes << std::setw(10) << res.stats.deadline_prunes
+                          << std::setw(10) << res.stats.bound_prunes << std::setw(10) << res.stats.memo_hits
+                          << std::setw(10) << res.stats.edf_prunes << std::setw(10) << res.stats.gap_prunes
+                          << std::setw(7) << res.stats.max_depth << std::setw(9) << res.makespan << "\n";
+                std::cout.flags(flags);
+                std::cout.precision(precision);
+                if (!res.valid) {
+                    std::cout << "    " << res.error << "\n";
+                }
+                if (csv.is_open()) {
+                    csv << scenario.name << "," << instance + 1 << "," << config.planted << "," << engine << ","
+                        << result << "," << res.time_s * 1000 << "," << res.stats.nodes << ","
+                        << res.stats.deadline_prunes << "," << res.stats.bound_prunes << "," << res.stats.memo_hits
+                        << "," << res.stats.edf_prunes << "," << res.stats.gap_prunes << "," << res.stats.max_depth
+                        << "," << res.makespan << "\n";
+                }
+            }
+            std::cout << std::endl;
+        }
+    }
+    if (failed) {
+        std::cout << "Benchmark FAILED: an engine gave an invalid schedule or a wrong feasibility verdict" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,62 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include "instance_generator.h"
+
+namespace {
+    void print_usage(const char *program) {
+        std::cerr << "Usage: " << program << " output_filename [options]\n"
+                  << "Options:\n"
+                  << "  --n <n>                 number of jobs (default 30)\n"
+                  << "  --slack <s>             window slack uniform in [0, s * total processing time] (default 0.8)\n"
+                  << "  --clusters <k>          number of release time clusters (default 6)\n"
+                  << "  --long-fraction <f>     fraction of long jobs (default 0.2)\n"
+                  << "  --unplanted             no planted feasible schedule, feasibility unknown\n"
+                  << "  --seed <seed>           random seed (default 0)" << std::endl;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return -1;
+    }
+    generator_config_t config;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--unplanted") {
+            config.planted = false;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << argv[i] << std::endl;
+            return -1;
+        }
+        const char *value = argv[++i];
+        if (arg == "--n") {
+            config.n = std::atoi(value);
+        } else if (arg == "--slack") {
+            config.slack = std::atof(value);
+        } else if (arg == "--clusters") {
+            config.clusters = std::atoi(value);
+        } else if (arg == "--long-fraction") {
+            config.long_fraction = std::atof(value);
+        } else if (arg == "--seed") {
+            config.seed = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            print_usage(argv[0]);
+            return -1;
+        }
+    }
+    if (config.n < 1 || config.clusters < 1) {
+        std::cerr << "At least 1 job and 1 cluster are needed" << std::endl;
+        return -1;
+    }
+    auto p = generate_instance(config);
+    if (!write_instance(p, argv[1])) {
+        std::cerr << "Could not write " << argv[1] << std::endl;
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "instance_generator.h"
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+    // Chance of an idle gap before a job of the planted schedule, and its largest length
+    const double IDLE_GAP_PROBABILITY = 0.1;
+    const int MAX_IDLE_GAP = 5;
+}
+
+problem_t generate_instance(const generator_config_t &config) {
+    std::mt19937 rng{config.seed};
+    std::uniform_real_distribution<double> unit(0, 1);
+    problem_t p;
+    p.n = std::max(1, config.n);
+    p.p.resize(p.n);
+    p.r.resize(p.n);
+    p.d.resize(p.n);
+    std::uniform_int_distribution<int> short_time(1, 10);
+    std::uniform_int_distribution<int> long_time(20, 60);
+    for (int j = 0; j < p.n; ++j) {
+        p.p[j] = unit(rng) < config.long_fraction ? long_time(rng) : short_time(rng);
+    }
+
+    std::vector<int> order(p.n);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), rng);
+    std::uniform_int_distribution<int> gap(1, MAX_IDLE_GAP);
+    std::vector<int> start(p.n), completion(p.n);
+    int c = 0;
+    for (int j: order) {
+        if (unit(rng) < IDLE_GAP_PROBABILITY) {
+            c += gap(rng);
+        }
+        start[j] = c;
+        c += p.p[j];
+        completion[j] = c;
+    }
+
+    // Clusters start in the first half of the planted schedule, the first one at 0, so every job has one before it
+    std::vector<int> cluster_starts{0};
+    std::uniform_int_distribution<int> cluster_start(0, c / 2);
+    for (int k = 1; k < config.clusters; ++k) {
+        cluster_starts.push_back(cluster_start(rng));
+    }
+    std::sort(cluster_starts.begin(), cluster_starts.end());
+    std::uniform_int_distribution<int> any_cluster(0, config.clusters - 1);
+
+    std::uniform_int_distribution<int> slack(0, std::max(0, static_cast<int>(config.slack * c)));
+    for (int j = 0; j < p.n; ++j) {
+        if (config.planted) {
+            p.r[j] = *(std::upper_bound(cluster_starts.begin(), cluster_starts.end(), start[j]) - 1);
+        } else {
+            p.r[j] = cluster_starts[any_cluster(rng)];
+        }
+        p.d[j] = p.r[j] + p.p[j] + slack(rng);
+        if (config.planted) {
+            p.d[j] = std::max(p.d[j], completion[j]);
+        }
+    }
+    return p;
+}
+
+bool write_instance(const problem_t &p, const std::string &filename) {
+    std::ofstream os{filename};
+    if (!os) {
+        return false;
+    }
+    os << p.n << "\n";
+    for (int j = 0; j < p.n; ++j) {
+        os << p.p[j] << " " << p.r[j] << " " << p.d[j] << "\n";
+    }
+    return static_cast<bool>(os);
+}
@@ -0,0 +1,38 @@
+#ifndef HW3_INSTANCE_GENERATOR_H
+#define HW3_INSTANCE_GENERATOR_H
+
+#include <string>
+#include "problem.h"
+
+/*!
+ * Parameters of a generated 1|r_j,d_j| instance. Jobs are released in clusters and each gets a window of its processing
+ * time plus a random slack. The search is hardest where about half of the instances are feasible, which for unplanted
+ * instances is around slack 0.8 with a handful of clusters
+ */
+struct generator_config_t {
+    int n = 30;
+    // Slack of a window is uniform in [0, slack * total processing time]
+    double slack = 0.8;
+    // Release times are the starts of this many clusters, spread over the first half of the schedule
+    int clusters = 6;
+    // Processing times are uniform in [1, 10], or in [20, 60] for this fraction of long jobs
+    double long_fraction = 0.2;
+    // A planted instance keeps a random schedule feasible: a job is released at the last cluster before its planted
+    // start and its deadline is at least its planted completion. Otherwise the jobs go to random clusters and the
+    // feasibility is unknown
+    bool planted = true;
+    unsigned seed = 0;
+};
+
+/*!
+ * Generate a random scheduling instance. The same config always gives the same instance
+ */
+problem_t generate_instance(const generator_config_t &config);
+
+/*!
+ * Write the instance in the input format of the task
+ * @return True if the file was written successfully
+ */
+bool write_instance(const problem_t &p, const std::string &filename);
+
+#endif //HW3_INSTANCE_GENERATOR_H
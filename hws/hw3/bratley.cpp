@@ -0,0 +1,602 @@
+#include "bratley.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include "failure_memo.h"
+#include "heuristic.h"
+#include "job_set.h"
+#include "trace.h"
+
+std::vector<int> get_visiting_order(const problem_t &p) {
+    // If all the release times are equal, the best nodes visiting order is by sorting them by deadlines, so abuse this here
+    std::vector<std::pair<int, int>> deadlines;
+    deadlines.reserve(p.n);
+    for (int i = 0; i < p.n; ++i) {
+        deadlines.emplace_back(p.d[i], i);
+    }
+    std::sort(deadlines.begin(), deadlines.end());
+    std::vector<int> res(p.n);
+    for (int i = 0; i < p.n; ++i) {
+        res[i] = deadlines[i].second;
+    }
+    return res;
+}
+
+
+namespace {
+    // The memo of a single search starts small, so easy instances do not pay for it, and grows up to MAX_MEMO_SIZE.
+    // A memo shared by threads has the maximum size from the start
+    const size_t INITIAL_MEMO_SIZE = 1 << 10;
+    const size_t MAX_MEMO_SIZE = 1 << 20;
+
+    // The parallel search splits the tree until there are this many prefixes per thread
+    const size_t TASKS_PER_THREAD = 16;
+
+    // Work between two reads of the clock when the search has a time limit. A node costs O(n) for its EDF bound and
+    // children scan, so this many jobs times nodes
+    const long long CLOCK_CHECK_WORK = 1 << 22;
+
+    // Upper bound of the objective before any schedule is known
+    const int NO_BOUND = std::numeric_limits<int>::max();
+
+    // Two smallest completion times of a remaining job started no earlier than some time, the first one with its job
+    struct earliest_completions_t {
+        int job = -1;
+        int first = std::numeric_limits<int>::max();
+        int second = std::numeric_limits<int>::max();
+
+        /*!
+         * A job that would start after an idle gap into which another remaining job fits is dominated: moving that
+         * job into the gap finishes it earlier and keeps the rest of the schedule
+         */
+        bool starts_after_gap(int job_index, int release) const {
+            return release >= (job_index == job ? second : first);
+        }
+    };
+
+    earliest_completions_t earliest_completions(const problem_t &p, const job_set_t &remaining, int c) {
+        earliest_completions_t res;
+        for (int job = remaining.first(); job != remaining.end(); job = remaining.next(job)) {
+            int completion = std::max(c, p.r[job]) + p.p[job];
+            if (completion < res.first) {
+                res.second = res.first;
+                res.first = completion;
+                res.job = job;
+            } else if (completion < res.second) {
+                res.second = completion;
+            }
+        }
+        return res;
+    }
+
+    // State of one depth-first search
+    class bratley_search_t {
+    public:
+        bratley_search_t(const problem_t &p, failure_memo_t &memo)
+                : p_{p}, unscheduled_{p, get_visiting_order(p)}, res_(p.n), memo_{memo},
+                  clock_check_nodes_{std::max(1LL, CLOCK_CHECK_WORK / std::max(1, p.n))} {
+            heap_.reserve(p.n);
+        }
+
+        /*!
+         * @param v current node
+         * @param depth depth in the tree
+         * @param c computation time of all the tasks before
+         * @return pair {<solution found>, <solution can be found>}. If both are false, the algorithm should terminate as there is no possiblity to find the optimal solution anymore
+         */
+        std::pair<bool, bool> dfs(int v, int depth, int c) {
+            ++stats_.nodes;
+            stats_.max_depth = std::max(stats_.max_depth, depth);
+            backjump_depth_ = 0;
+            if (stopped()) {
+                return {false, false};
+            }
+            if (std::max(c, p_.r[v]) + p_.p[v] > deadline(v)) {
+                ++stats_.deadline_prunes;
+                return {false, true};
+            }
+            res_[depth - 1] = v;
+
+            // If reached a leaf, the solution is feasible. When minimizing, it is also better than the best one, which
+            // it replaces, and the search goes on
+            if (depth == p_.n) {
+                if (!optimizing_) {
+                    return {true, true};
+                }
+                best_ = res_;
+                upper_bound_ = objective_value(p_, best_, objective_);
+                ++stats_.improvements;
+                set_backjump();
+                // No schedule is below the lower bound, so the search is over when it is reached
+                return {false, upper_bound_ != lower_bound_};
+            }
+
+            unscheduled_.remove(v);
+            const int min_release_time = unscheduled_.min_release_time();
+            const int max_deadline = deadline_bound(unscheduled_.max_deadline());
+            const int total_work_left = unscheduled_.total_work();
+
+            int c_new = std::max(c, p_.r[v]) + p_.p[v];
+            // Set if the first part of the solution is already optimal. The remaining jobs then cannot start before
+            // their release times whatever was scheduled, so if they fail here, they fail everywhere
+            bool already_optimal = false;
+            if (min_release_time >= c_new) {
+                already_optimal = true;
+            }
+
+            // If there is no possibility to find any feasible solution in this subtree, return false
+            if (std::max(c_new, min_release_time) + total_work_left > max_deadline) {
+                ++stats_.bound_prunes;
+                unscheduled_.restore(v);
+                return {false, !already_optimal};
+            }
+
+            // The same jobs were left before at the same or an earlier time and could not be scheduled
+            if (memo_.failed(unscheduled_.hash(), c_new)) {
+                ++stats_.memo_hits;
+                unscheduled_.restore(v);
+                return {false, !already_optimal};
+            }
+
+            if (!preemptive_edf_feasible(c_new)) {
+                ++stats_.edf_prunes;
+                unscheduled_.restore(v);
+                return {false, !already_optimal};
+            }
+
+            const auto earliest = earliest_completions(p_, unscheduled_, c_new);
+            for (int node = unscheduled_.first(); node != unscheduled_.end(); node = unscheduled_.next(node)) {
+                if (earliest.starts_after_gap(node, p_.r[node])) {
+                    ++stats_.gap_prunes;
+                    continue;
+                }
+                auto dfs_res = dfs(node, depth + 1, c_new);
+                if (dfs_res.first) {
+                    unscheduled_.restore(v);
+                    return {true, true};
+                }
+                if (!dfs_res.second) {
+                    unscheduled_.restore(v);
+                    return {false, false};
+                }
+                // The subtree is left unexplored, so it is not a failure to remember
+                if (backjump_depth_ != 0 && depth >= backjump_depth_) {
+                    unscheduled_.restore(v);
+                    return {false, true};
+                }
+            }
+            memo_.insert(unscheduled_.hash(), c_new);
+            unscheduled_.restore(v);
+            return {false, !already_optimal};
+        }
+
+        /*!
+         * Search the subtree under a prefix of jobs as dfs() does under its last job. The other jobs of the prefix are
+         * only scheduled, without checks
+         */
+        std::pair<bool, bool> search_prefix(const std::vector<int> &prefix) {
+            int c = 0;
+            for (size_t i = 0; i + 1 < prefix.size(); ++i) {
+                unscheduled_.remove(prefix[i]);
+                res_[i] = prefix[i];
+                c = std::max(c, p_.r[prefix[i]]) + p_.p[prefix[i]];
+            }
+            auto res = dfs(prefix.back(), static_cast<int>(prefix.size()), c);
+            for (size_t i = prefix.size() - 1; i-- > 0;) {
+                unscheduled_.restore(prefix[i]);
+            }
+            return res;
+        }
+
+        /*!
+         * Turn the search into the minimization of the objective: the deadlines are tightened so that only schedules
+         * better than the best one known are feasible, and each schedule found replaces the best one. The already
+         * optimal prefix rule then stops the search once no better schedule exists. The memo stays valid, as the
+         * deadlines only get tighter
+         * @param best Schedule to improve on, or empty if none is known
+         * @param lower_bound The search stops when it finds a schedule of this objective
+         * @param time_limit_end If not null, dfs() gives up, returning {false, false}, once this time passes
+         */
+        void minimize(objective_t objective, const std::vector<int> &best, int lower_bound,
+                      const std::chrono::steady_clock::time_point *time_limit_end) {
+            optimizing_ = true;
+            objective_ = objective;
+            lower_bound_ = lower_bound;
+            best_ = best;
+            upper_bound_ = best.empty() ? NO_BOUND : objective_value(p_, best, objective);
+            set_time_limit(time_limit_end);
+        }
+
+        //! Make dfs() give up, returning {false, false}, once this time passes. Nothing changes if it is null
+        void set_time_limit(const std::chrono::steady_clock::time_point *time_limit_end) {
+            if (time_limit_end) {
+                has_time_limit_ = true;
+                time_limit_end_ = *time_limit_end;
+            }
+        }
+
+        /*!
+         * Make dfs() give up, returning {false, false}, once first_solved drops below task. Used by the parallel search
+         * to cancel subtrees that come after an already found schedule
+         */
+        void cancel_when(const std::atomic<int> *first_solved, int task) {
+            first_solved_ = first_solved;
+            task_ = task;
+        }
+
+        const job_set_t &unscheduled() const {
+            return unscheduled_;
+        }
+
+        const std::vector<int> &result() const {
+            return res_;
+        }
+
+        const search_stats_t &stats() const {
+            return stats_;
+        }
+
+        //! Best schedule found while minimizing
+        const std::vector<int> &best() const {
+            return best_;
+        }
+
+        bool timed_out() const {
+            return timed_out_;
+        }
+
+    private:
+        bool stopped() {
+            if (has_time_limit_ && stats_.nodes % clock_check_nodes_ == 0 &&
+                std::chrono::steady_clock::now() >= time_limit_end_) {
+                timed_out_ = true;
+            }
+            return timed_out_ || (first_solved_ != nullptr && first_solved_->load(std::memory_order_relaxed) < task_);
+        }
+
+        /*!
+         * After an improvement, find the first job of the current path that misses its tightened deadline. Nodes from
+         * its depth down were entered under the old bound and lead to no better schedule, so the search backtracks
+         * above them. The job itself fails the deadline check there, so its parent still fails exactly when its
+         * children do
+         */
+        void set_backjump() {
+            int c = 0;
+            for (int depth = 1; depth <= p_.n; ++depth) {
+                const int job = res_[depth - 1];
+                c = std::max(c, p_.r[job]) + p_.p[job];
+                if (c > deadline(job)) {
+                    backjump_depth_ = depth;
+                    return;
+                }
+            }
+        }
+
+        // Deadline of a job that a schedule better than the best known must meet
+        int deadline(int job) const {
+            return deadline_bound(p_.d[job]);
+        }
+
+        // Monotone in d, so it maps the maximum deadline of the remaining jobs to the maximum of their bounds
+        int deadline_bound(int d) const {
+            if (!optimizing_ || upper_bound_ == NO_BOUND) {
+                return d;
+            }
+            if (objective_ == objective_t::MAKESPAN) {
+                return std::min(d, upper_bound_ - 1);
+            }
+            return d + upper_bound_ - 1;
+        }
+
+        /*!
+         * Jackson's preemptive EDF schedule of the remaining jobs from time t: the released job with the earliest
+         * deadline runs until it finishes or another job is released. It is optimal when preemption is allowed, so if
+         * a job misses its deadline there, no schedule of the remaining jobs exists. O(n log n)
+         */
+        bool preemptive_edf_feasible(int t) {
+            // Pairs {deadline, processing time left}, ordered by the deadline only, so the time left can be changed
+            auto later_deadline = [](const std::pair<int, int> &a, const std::pair<int, int> &b) {
+                return a.first > b.first;
+            };
+            heap_.clear();
+            int next = unscheduled_.first_released();
+            while (next != unscheduled_.end() || !heap_.empty()) {
+                if (heap_.empty()) {
+                    t = std::max(t, p_.r[next]);
+                }
+                for (; next != unscheduled_.end() && p_.r[next] <= t; next = unscheduled_.next_released(next)) {
+                    heap_.emplace_back(deadline(next), p_.p[next]);
+                    std::push_heap(heap_.begin(), heap_.end(), later_deadline);
+                }
+                auto &job = heap_.front();
+                int run = job.second;
+                if (next != unscheduled_.end()) {
+                    run = std::min(run, p_.r[next] - t);
+                }
+                t += run;
+                job.second -= run;
+                if (job.second == 0) {
+                    if (t > job.first) {
+                        return false;
+                    }
+                    std::pop_heap(heap_.begin(), heap_.end(), later_deadline);
+                    heap_.pop_back();
+                }
+            }
+            return true;
+        }
+
+        const problem_t &p_;
+        job_set_t unscheduled_;
+        std::vector<int> res_;
+        failure_memo_t &memo_;
+        std::vector<std::pair<int, int>> heap_;
+        search_stats_t stats_;
+        const std::atomic<int> *first_solved_ = nullptr;
+        int task_ = 0;
+        bool optimizing_ = false;
+        objective_t objective_ = objective_t::MAKESPAN;
+        int upper_bound_ = NO_BOUND;
+        int lower_bound_ = 0;
+        // Nodes at this depth and below backtrack without exploring further, 0 for none
+        int backjump_depth_ = 0;
+        std::vector<int> best_;
+        bool has_time_limit_ = false;
+        bool timed_out_ = false;
+        long long clock_check_nodes_;
+        std::chrono::steady_clock::time_point time_limit_end_;
+    };
+
+    std::vector<int> solve_sequential(const problem_t &p, search_stats_t &stats,
+                                      const std::chrono::steady_clock::time_point *time_limit_end, bool &finished) {
+        failure_memo_t memo{INITIAL_MEMO_SIZE, MAX_MEMO_SIZE};
+        bratley_search_t search{p, memo};
+        search.set_time_limit(time_limit_end);
+        std::vector<int> res;
+        const auto earliest = earliest_completions(p, search.unscheduled(), 0);
+        for (int i = 0; i < p.n; ++i) {
+            if (earliest.starts_after_gap(i, p.r[i])) {
+                continue;
+            }
+            auto solver_res = search.dfs(i, 1, 0);
+            if (solver_res.first) {
+                res = search.result();
+                break;
+            }
+            if (!solver_res.second) {
+                break;
+            }
+        }
+        stats = search.stats();
+        finished = !search.timed_out() || !res.empty();
+        return res;
+    }
+
+    /*!
+     * Prefixes of the search tree in the order in which the sequential search visits them, expanded level by level
+     * until there are at least target of them. Jobs are filtered as dfs() filters children, by the idle gap dominance
+     * and by their own deadline
+     */
+    std::vector<std::vector<int>> split_search_tree(const problem_t &p, size_t target) {
+        job_set_t remaining{p, get_visiting_order(p)};
+        std::vector<std::vector<int>> prefixes;
+        const auto roots = earliest_completions(p, remaining, 0);
+        for (int i = 0; i < p.n; ++i) {
+            if (!roots.starts_after_gap(i, p.r[i]) && p.r[i] + p.p[i] <= p.d[i]) {
+                prefixes.push_back({i});
+            }
+        }
+        // The last job of a prefix is left to dfs(), which needs it above the leaves
+        for (int depth = 1; depth < p.n - 1 && !prefixes.empty() && prefixes.size() < target; ++depth) {
+            std::vector<std::vector<int>> next;
+            for (const auto &prefix: prefixes) {
+                int c = 0;
+                for (int job: prefix) {
+                    remaining.remove(job);
+                    c = std::max(c, p.r[job]) + p.p[job];
+                }
+                const auto earliest = earliest_completions(p, remaining, c);
+                for (int job = remaining.first(); job != remaining.end(); job = remaining.next(job)) {
+                    if (!earliest.starts_after_gap(job, p.r[job]) && std::max(c, p.r[job]) + p.p[job] <= p.d[job]) {
+                        next.push_back(prefix);
+                        next.back().push_back(job);
+                    }
+                }
+                for (auto it = prefix.rbegin(); it != prefix.rend(); ++it) {
+                    remaining.restore(*it);
+                }
+            }
+            prefixes.swap(next);
+        }
+        return prefixes;
+    }
+
+    // Tasks of one worker thread. The owner takes them from the front, thieves from the back
+    struct task_queue_t {
+        std::mutex mutex;
+        std::deque<int> tasks;
+    };
+
+    // Next task for thread tid, its own or a stolen one, or -1 if no task is left anywhere
+    int take_task(std::vector<task_queue_t> &queues, int tid, long long &steals) {
+        {
+            std::lock_guard<std::mutex> lock{queues[tid].mutex};
+            if (!queues[tid].tasks.empty()) {
+                int task = queues[tid].tasks.front();
+                queues[tid].tasks.pop_front();
+                return task;
+            }
+        }
+        const int threads = static_cast<int>(queues.size());
+        for (int i = 1; i < threads; ++i) {
+            auto &victim = queues[(tid + i) % threads];
+            std::lock_guard<std::mutex> lock{victim.mutex};
+            if (!victim.tasks.empty()) {
+                int task = victim.tasks.back();
+                victim.tasks.pop_back();
+                ++steals;
+                return task;
+            }
+        }
+        return -1;
+    }
+
+    /*!
+     * The tree is split into prefixes, which are dealt round-robin to the threads and searched on a work-stealing pool,
+     * each thread with its own search state and all of them with a shared failure memo. Prefixes are numbered in the
+     * order of the sequential search, and the lowest one with a schedule wins, so the result equals the sequential one.
+     * Finding a schedule cancels the prefixes after it, and proving that none exists cancels all of them. If the time
+     * limit stops a prefix before any schedule is found, the result is unknown
+     */
+    std::vector<int> solve_parallel(const problem_t &p, int threads, search_stats_t &stats,
+                                    const std::chrono::steady_clock::time_point *time_limit_end, bool &finished) {
+        TraceSpan span{"work_stealing"};
+        const auto prefixes = split_search_tree(p, TASKS_PER_THREAD * threads);
+        std::vector<task_queue_t> queues(threads);
+        for (size_t i = 0; i < prefixes.size(); ++i) {
+            queues[i % threads].tasks.push_back(static_cast<int>(i));
+        }
+        failure_memo_t memo{MAX_MEMO_SIZE, MAX_MEMO_SIZE};
+        // Lowest prefix whose subtree has a schedule, -1 once no schedule can exist
+        std::atomic<int> first_solved{std::numeric_limits<int>::max()};
+        std::mutex result_mutex;
+        std::vector<int> res;
+        std::vector<search_stats_t> thread_stats(threads);
+        std::vector<long long> thread_steals(threads, 0);
+        std::atomic<bool> timed_out{false};
+
+        auto worker = [&](int tid) {
+            bratley_search_t search{p, memo};
+            search.set_time_limit(time_limit_end);
+            for (int task; (task = take_task(queues, tid, thread_steals[tid])) >= 0;) {
+                if (first_solved.load(std::memory_order_relaxed) < task) {
+                    continue;
+                }
+                search.cancel_when(&first_solved, task);
+                auto solver_res = search.search_prefix(prefixes[task]);
+                if (solver_res.first) {
+                    std::lock_guard<std::mutex> lock{result_mutex};
+                    if (task < first_solved.load(std::memory_order_relaxed)) {
+                        res = search.result();
+                        first_solved.store(task, std::memory_order_relaxed);
+                    }
+                } else if (search.timed_out()) {
+                    timed_out.store(true, std::memory_order_relaxed);
+                } else if (!solver_res.second && first_solved.load(std::memory_order_relaxed) >= task) {
+                    // Not cancelled, so the search proved that the jobs left after an optimal prefix fail
+                    std::lock_guard<std::mutex> lock{result_mutex};
+                    first_solved.store(-1, std::memory_order_relaxed);
+                }
+            }
+            thread_stats[tid] = search.stats();
+        };
+        std::vector<std::thread> workers;
+        for (int tid = 1; tid < threads; ++tid) {
+            workers.emplace_back(worker, tid);
+        }
+        worker(0);
+        for (auto &w: workers) {
+            w.join();
+        }
+
+        long long steals = 0;
+        for (int tid = 0; tid < threads; ++tid) {
+            stats += thread_stats[tid];
+            steals += thread_steals[tid];
+        }
+        span.set_arg("threads", threads);
+        span.set_arg("tasks", static_cast<long long>(prefixes.size()));
+        span.set_arg("steals", steals);
+        if (first_solved.load() < 0) {
+            res.clear();
+        }
+        finished = !timed_out.load() || !res.empty();
+        return res;
+    }
+}
+
+search_stats_t &search_stats_t::operator+=(const search_stats_t &other) {
+    nodes += other.nodes;
+    deadline_prunes += other.deadline_prunes;
+    bound_prunes += other.bound_prunes;
+    memo_hits += other.memo_hits;
+    edf_prunes += other.edf_prunes;
+    gap_prunes += other.gap_prunes;
+    improvements += other.improvements;
+    max_depth = std::max(max_depth, other.max_depth);
+    return *this;
+}
+
+std::vector<int> solve_scheduling(const problem_t &p, int threads, search_stats_t *stats_out, double time_limit,
+                                  bool *finished_out) {
+    TraceSpan span{"branch_and_bound"};
+    const auto end = std::chrono::steady_clock::now() +
+                     std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                             std::chrono::duration<double>(time_limit));
+    search_stats_t stats;
+    bool finished = true;
+    auto res = threads > 1 ? solve_parallel(p, threads, stats, time_limit > 0 ? &end : nullptr, finished)
+                           : solve_sequential(p, stats, time_limit > 0 ? &end : nullptr, finished);
+    if (finished_out) {
+        *finished_out = finished;
+    }
+    if (stats_out) {
+        *stats_out += stats;
+    }
+    span.set_arg("nodes", stats.nodes);
+    span.set_arg("memo_hits", stats.memo_hits);
+    span.set_arg("edf_prunes", stats.edf_prunes);
+    span.set_arg("feasible", !res.empty());
+    return res;
+}
+
+optimization_result_t optimize_schedule(const problem_t &p, objective_t objective, double time_limit,
+                                        search_stats_t *stats_out) {
+    TraceSpan span{"optimize"};
+    optimization_result_t res;
+    // Anytime search: the heuristic schedule is the answer until the search improves it
+    auto initial = schrage_order(p);
+    if (objective == objective_t::MAKESPAN && !meets_deadlines(p, initial)) {
+        initial.clear();
+    }
+    const int lower_bound = objective_lower_bound(p, objective);
+    search_stats_t stats;
+    // Every schedule is at least the lower bound, so a heuristic one that reaches it is optimal
+    if (!initial.empty() && objective_value(p, initial, objective) == lower_bound) {
+        res.order = initial;
+    } else {
+        const auto end = std::chrono::steady_clock::now() +
+                         std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                 std::chrono::duration<double>(time_limit));
+        failure_memo_t memo{INITIAL_MEMO_SIZE, MAX_MEMO_SIZE};
+        bratley_search_t search{p, memo};
+        search.minimize(objective, initial, lower_bound, time_limit > 0 ? &end : nullptr);
+        const auto earliest = earliest_completions(p, search.unscheduled(), 0);
+        for (int i = 0; i < p.n; ++i) {
+            if (earliest.starts_after_gap(i, p.r[i])) {
+                continue;
+            }
+            if (!search.dfs(i, 1, 0).second) {
+                break;
+            }
+        }
+        res.order = search.best();
+        res.optimal = !search.timed_out();
+        stats = search.stats();
+    }
+    if (!res.order.empty()) {
+        res.value = objective_value(p, res.order, objective);
+    }
+    if (stats_out) {
+        *stats_out += stats;
+    }
+    span.set_arg("nodes", stats.nodes);
+    span.set_arg("improvements", stats.improvements);
+    span.set_arg("value", res.value);
+    span.set_arg("optimal", res.optimal);
+    return res;
+}
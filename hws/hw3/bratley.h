@@ -0,0 +1,63 @@
+#ifndef HW3_BRATLEY_H
+#define HW3_BRATLEY_H
+
+#include <vector>
+#include "problem.h"
+
+/*!
+ * Order in which the branch-and-bound tries unscheduled jobs: by deadlines
+ */
+std::vector<int> get_visiting_order(const problem_t &p);
+
+//! Work of the branch-and-bound. Prunes are counted by the rule that cut the node
+struct search_stats_t {
+    long long nodes = 0;
+    long long deadline_prunes = 0; // The job of the node misses its deadline
+    long long bound_prunes = 0; // The remaining work does not fit before the latest remaining deadline
+    long long memo_hits = 0;
+    long long edf_prunes = 0;
+    long long gap_prunes = 0; // Children not branched on as they would leave an idle gap another job fits into
+    long long improvements = 0; // Schedules that improved the best one when minimizing
+    int max_depth = 0;
+
+    //! Sums the counters, the maximum depth is the larger one
+    search_stats_t &operator+=(const search_stats_t &other);
+};
+
+/*!
+ * Find a schedule respecting release times and deadlines by Bratley's branch-and-bound. A node is pruned when Jackson's
+ * preemptive EDF schedule of the remaining jobs misses a deadline, or when a memo of failed nodes shows the same
+ * remaining jobs could not be scheduled from the same or an earlier time. Jobs that would leave an idle gap another job
+ * fits into are not branched on
+ * @param threads With more than 1, the tree is split at a shallow depth and searched on a work-stealing pool of this
+ * many threads sharing the memo. The result is the same as that of the sequential search
+ * @param stats If not null, the work of the search is added to it
+ * @param time_limit Seconds after which the search gives up, 0 for no limit
+ * @param finished If not null, set to false if the time limit stopped the search before it found a schedule or proved
+ * that none exists. The empty result then means nothing
+ * @return Jobs in the order of execution, or an empty vector if no feasible schedule exists
+ */
+std::vector<int> solve_scheduling(const problem_t &p, int threads = 1, search_stats_t *stats = nullptr,
+                                  double time_limit = 0, bool *finished = nullptr);
+
+struct optimization_result_t {
+    //! Jobs in the order of execution, or empty if no schedule meeting the deadlines was found
+    std::vector<int> order;
+    //! Objective of the order
+    int value = 0;
+    //! False if the time limit stopped the search before it proved the order optimal
+    bool optimal = true;
+};
+
+/*!
+ * Find the schedule with the minimum makespan, which meets the deadlines, or with the minimum maximum lateness, for
+ * which deadlines are due dates. Schrage's heuristic gives the first upper bound. The branch-and-bound of
+ * solve_scheduling() then runs once with deadlines tightened by the best objective found, so every schedule it reaches
+ * improves the bound and the pruning gets stronger as it goes, without restarting the search
+ * @param time_limit Seconds after which the best schedule found so far is returned, 0 for no limit
+ * @param stats If not null, the work of the search is added to it
+ */
+optimization_result_t optimize_schedule(const problem_t &p, objective_t objective, double time_limit = 0,
+                                        search_stats_t *stats = nullptr);
+
+#endif //HW3_BRATLEY_H
@@ -0,0 +1,64 @@
+#include "failure_memo.h"
+#include <algorithm>
+
+namespace {
+    // Times are stored plus one, so zero data marks an empty entry
+    unsigned long long encode(int c) {
+        return static_cast<unsigned long long>(c) + 1;
+    }
+}
+
+failure_memo_t::failure_memo_t(size_t initial_size, size_t max_size)
+        : size_{initial_size}, max_size_{std::max(initial_size, max_size)}, entries_{new entry_t[initial_size]} {}
+
+long long failure_memo_t::stored_time(const entry_t &entry, unsigned long long key) const {
+    const unsigned long long data = entry.data.load(std::memory_order_relaxed);
+    if (data == 0 || (entry.check.load(std::memory_order_relaxed) ^ data) != key) {
+        return -1;
+    }
+    return static_cast<long long>(data) - 1;
+}
+
+bool failure_memo_t::failed(unsigned long long key, int c) const {
+    const long long time = stored_time(entries_[key & (size_ - 1)], key);
+    return time >= 0 && time <= c;
+}
+
+void failure_memo_t::insert(unsigned long long key, int c) {
+    if (2 * used_ >= size_ && size_ < max_size_) {
+        grow();
+    }
+    entry_t &entry = entries_[key & (size_ - 1)];
+    const long long time = stored_time(entry, key);
+    if (time >= 0 && time <= c) {
+        return;
+    }
+    // A shared table does not grow, so it does not count entries either
+    if (size_ < max_size_ && entry.data.load(std::memory_order_relaxed) == 0) {
+        ++used_;
+    }
+    const unsigned long long data = encode(c);
+    entry.data.store(data, std::memory_order_relaxed);
+    entry.check.store(key ^ data, std::memory_order_relaxed);
+}
+
+void failure_memo_t::grow() {
+    std::unique_ptr<entry_t[]> old{new entry_t[2 * size_]};
+    old.swap(entries_);
+    const size_t old_size = size_;
+    size_ *= 2;
+    used_ = 0;
+    for (size_t i = 0; i < old_size; ++i) {
+        const unsigned long long data = old[i].data.load(std::memory_order_relaxed);
+        if (data == 0) {
+            continue;
+        }
+        const unsigned long long key = old[i].check.load(std::memory_order_relaxed) ^ data;
+        entry_t &entry = entries_[key & (size_ - 1)];
+        if (entry.data.load(std::memory_order_relaxed) == 0) {
+            ++used_;
+        }
+        entry.data.store(data, std::memory_order_relaxed);
+        entry.check.store(old[i].check.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
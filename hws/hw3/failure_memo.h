@@ -0,0 +1,44 @@
+#ifndef HW3_FAILURE_MEMO_H
+#define HW3_FAILURE_MEMO_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/*!
+ * Direct-mapped table of search nodes that failed: the remaining jobs with a given hash cannot be scheduled from a
+ * given time on, so neither from any later time. An entry is indexed by the low bits of the hash, and a colliding one
+ * is replaced.
+ *
+ * Entries are two atomic words, the encoded time and its XOR with the hash, so threads may share a table without locks:
+ * an entry torn by concurrent writes does not verify and reads as missing. Only a table used by a single thread grows,
+ * doubling while half full
+ */
+class failure_memo_t {
+public:
+    //! Table of initial_size entries that grows up to max_size. Both must be powers of two
+    failure_memo_t(size_t initial_size, size_t max_size);
+
+    //! True if the jobs with this hash failed from time c or an earlier one
+    bool failed(unsigned long long key, int c) const;
+
+    void insert(unsigned long long key, int c);
+
+private:
+    struct entry_t {
+        std::atomic<unsigned long long> check{0};
+        std::atomic<unsigned long long> data{0};
+    };
+
+    // Time stored in an entry whose check matches key, or -1 if there is none
+    long long stored_time(const entry_t &entry, unsigned long long key) const;
+
+    void grow();
+
+    size_t size_;
+    size_t max_size_;
+    size_t used_ = 0;
+    std::unique_ptr<entry_t[]> entries_;
+};
+
+#endif //HW3_FAILURE_MEMO_H
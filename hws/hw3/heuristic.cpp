@@ -0,0 +1,77 @@
+#include "heuristic.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <queue>
+
+namespace {
+    std::vector<int> jobs_by_release(const problem_t &p) {
+        std::vector<int> jobs(p.n);
+        std::iota(jobs.begin(), jobs.end(), 0);
+        std::stable_sort(jobs.begin(), jobs.end(), [&p](int a, int b) {
+            return p.r[a] < p.r[b];
+        });
+        return jobs;
+    }
+
+    // Pairs {deadline, job or processing time left} with the earliest deadline on top
+    using deadline_heap_t = std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>,
+            std::greater<std::pair<int, int>>>;
+}
+
+std::vector<int> schrage_order(const problem_t &p) {
+    const auto by_release = jobs_by_release(p);
+    std::vector<int> order;
+    order.reserve(p.n);
+    deadline_heap_t released;
+    int t = 0;
+    for (size_t next = 0; next < by_release.size() || !released.empty();) {
+        if (released.empty()) {
+            t = std::max(t, p.r[by_release[next]]);
+        }
+        for (; next < by_release.size() && p.r[by_release[next]] <= t; ++next) {
+            released.emplace(p.d[by_release[next]], by_release[next]);
+        }
+        const int job = released.top().second;
+        released.pop();
+        order.push_back(job);
+        t += p.p[job];
+    }
+    return order;
+}
+
+int objective_lower_bound(const problem_t &p, objective_t objective) {
+    const auto by_release = jobs_by_release(p);
+    if (objective == objective_t::MAKESPAN) {
+        int c = 0;
+        for (int job: by_release) {
+            c = std::max(c, p.r[job]) + p.p[job];
+        }
+        return c;
+    }
+
+    int max_lateness = std::numeric_limits<int>::min();
+    deadline_heap_t released;
+    int t = 0;
+    for (size_t next = 0; next < by_release.size() || !released.empty();) {
+        if (released.empty()) {
+            t = std::max(t, p.r[by_release[next]]);
+        }
+        for (; next < by_release.size() && p.r[by_release[next]] <= t; ++next) {
+            released.emplace(p.d[by_release[next]], p.p[by_release[next]]);
+        }
+        auto job = released.top();
+        released.pop();
+        int run = job.second;
+        if (next < by_release.size()) {
+            run = std::min(run, p.r[by_release[next]] - t);
+        }
+        t += run;
+        if (run == job.second) {
+            max_lateness = std::max(max_lateness, t - job.first);
+        } else {
+            released.emplace(job.first, job.second - run);
+        }
+    }
+    return max_lateness;
+}
@@ -0,0 +1,21 @@
+#ifndef HW3_HEURISTIC_H
+#define HW3_HEURISTIC_H
+
+#include <vector>
+#include "problem.h"
+
+/*!
+ * Schrage's list scheduling: whenever the machine is free, the released job with the earliest deadline starts, and if
+ * none is released, the machine waits for the next release. O(n log n)
+ * @return Jobs in the order of execution
+ */
+std::vector<int> schrage_order(const problem_t &p);
+
+/*!
+ * Lower bound of the objective of any schedule, deadlines aside. The makespan of jobs started as soon as released in
+ * the order of release times is optimal, and the maximum lateness of Jackson's preemptive EDF schedule is optimal when
+ * preemption is allowed
+ */
+int objective_lower_bound(const problem_t &p, objective_t objective);
+
+#endif //HW3_HEURISTIC_H
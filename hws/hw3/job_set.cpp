@@ -0,0 +1,92 @@
+#include "job_set.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+
+namespace {
+    const int NO_RELEASE = std::numeric_limits<int>::max();
+    const int NO_DEADLINE = std::numeric_limits<int>::min();
+
+    void link_in_order(const std::vector<int> &order, int head, std::vector<int> &next, std::vector<int> &prev) {
+        int last = head;
+        for (int job: order) {
+            next[last] = job;
+            prev[job] = last;
+            last = job;
+        }
+        next[last] = head;
+        prev[head] = last;
+    }
+
+    void unlink(int job, std::vector<int> &next, std::vector<int> &prev) {
+        next[prev[job]] = next[job];
+        prev[next[job]] = prev[job];
+    }
+
+    // The neighbours still point around the job as nothing else was removed since
+    void relink(int job, std::vector<int> &next, std::vector<int> &prev) {
+        next[prev[job]] = job;
+        prev[next[job]] = job;
+    }
+}
+
+job_set_t::job_set_t(const problem_t &p, const std::vector<int> &order)
+        : p_{p}, head_{p.n}, next_(p.n + 1), prev_(p.n + 1), next_released_(p.n + 1), prev_released_(p.n + 1),
+          job_keys_(p.n) {
+    link_in_order(order, head_, next_, prev_);
+    std::vector<int> by_release(p.n);
+    std::iota(by_release.begin(), by_release.end(), 0);
+    std::stable_sort(by_release.begin(), by_release.end(), [&p](int a, int b) {
+        return p.r[a] < p.r[b];
+    });
+    link_in_order(by_release, head_, next_released_, prev_released_);
+
+    // Fixed seed, so the search is deterministic
+    std::mt19937_64 rng(0x5eed);
+    for (auto &key: job_keys_) {
+        key = rng();
+        hash_ ^= key;
+    }
+
+    while (leaves_ < p.n) {
+        leaves_ *= 2;
+    }
+    min_release_.assign(2 * leaves_, NO_RELEASE);
+    max_deadline_.assign(2 * leaves_, NO_DEADLINE);
+    for (int i = 0; i < p.n; ++i) {
+        min_release_[leaves_ + i] = p.r[i];
+        max_deadline_[leaves_ + i] = p.d[i];
+        total_work_ += p.p[i];
+    }
+    for (int i = leaves_ - 1; i >= 1; --i) {
+        min_release_[i] = std::min(min_release_[2 * i], min_release_[2 * i + 1]);
+        max_deadline_[i] = std::max(max_deadline_[2 * i], max_deadline_[2 * i + 1]);
+    }
+}
+
+void job_set_t::remove(int job) {
+    unlink(job, next_, prev_);
+    unlink(job, next_released_, prev_released_);
+    hash_ ^= job_keys_[job];
+    total_work_ -= p_.p[job];
+    update_leaf(job, NO_RELEASE, NO_DEADLINE);
+}
+
+void job_set_t::restore(int job) {
+    relink(job, next_, prev_);
+    relink(job, next_released_, prev_released_);
+    hash_ ^= job_keys_[job];
+    total_work_ += p_.p[job];
+    update_leaf(job, p_.r[job], p_.d[job]);
+}
+
+void job_set_t::update_leaf(int job, int release, int deadline) {
+    int i = leaves_ + job;
+    min_release_[i] = release;
+    max_deadline_[i] = deadline;
+    for (i /= 2; i >= 1; i /= 2) {
+        min_release_[i] = std::min(min_release_[2 * i], min_release_[2 * i + 1]);
+        max_deadline_[i] = std::max(max_deadline_[2 * i], max_deadline_[2 * i + 1]);
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef HW3_JOB_SET_H
+#define HW3_JOB_SET_H
+
+#include <vector>
+#include "problem.h"
+
+/*!
+ * Jobs that are not scheduled yet, for a depth-first search that removes and restores them in LIFO order.
+ * Jobs are kept in two doubly linked lists, one in the visiting order and one by release times, so removing and
+ * restoring a job is O(1) and iterating visits only the remaining jobs. The minimum release time and the maximum
+ * deadline of the remaining jobs are kept in segment trees over the job indices and their total processing time as a
+ * running sum, so each removal or restoration costs O(log n) and the aggregates are read in O(1). The set also keeps a
+ * Zobrist hash (XOR of random per-job keys) that identifies it in memo tables
+ */
+class job_set_t {
+public:
+    //! Set of all the jobs of p, iterated in the given order
+    job_set_t(const problem_t &p, const std::vector<int> &order);
+
+    void remove(int job);
+
+    //! Put back the job removed last
+    void restore(int job);
+
+    // Iteration over the remaining jobs: for (int j = set.first(); j != set.end(); j = set.next(j))
+    int first() const {
+        return next_[head_];
+    }
+
+    int next(int job) const {
+        return next_[job];
+    }
+
+    int end() const {
+        return head_;
+    }
+
+    // Iteration over the remaining jobs by release times, ended by end() as well
+    int first_released() const {
+        return next_released_[head_];
+    }
+
+    int next_released(int job) const {
+        return next_released_[job];
+    }
+
+    bool empty() const {
+        return next_[head_] == head_;
+    }
+
+    //! Minimum release time of the remaining jobs, INT_MAX if there are none
+    int min_release_time() const {
+        return min_release_[1];
+    }
+
+    //! Maximum deadline of the remaining jobs, INT_MIN if there are none
+    int max_deadline() const {
+        return max_deadline_[1];
+    }
+
+    //! Total processing time of the remaining jobs
+    int total_work() const {
+        return total_work_;
+    }
+
+    //! Zobrist hash of the set of remaining jobs
+    unsigned long long hash() const {
+        return hash_;
+    }
+
+private:
+    void update_leaf(int job, int release, int deadline);
+
+    const problem_t &p_;
+    // Linked list of the remaining jobs with a sentinel head_ = n
+    int head_;
+    std::vector<int> next_;
+    std::vector<int> prev_;
+    std::vector<int> next_released_;
+    std::vector<int> prev_released_;
+    // Segment trees with the leaf of job i at leaves_ + i and the root at 1
+    int leaves_ = 1;
+    std::vector<int> min_release_;
+    std::vector<int> max_deadline_;
+    int total_work_ = 0;
+    std::vector<unsigned long long> job_keys_;
+    unsigned long long hash_ = 0;
+};
+
+#endif //HW3_JOB_SET_H
@@ -0,0 +1,291 @@
+#include "local_search.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <random>
+#include "heuristic.h"
+#include "trace.h"
+
+namespace {
+    // Jobs tried to be moved for a late job, and positions scanned for where to move them to. Blocks can span most
+    // of the schedule, so trying all of their jobs would make a single step quadratic
+    const int MAX_CANDIDATES = 64;
+
+    // Maximum and sum of the positive parts of the lateness by position
+    class lateness_tree_t {
+    public:
+        explicit lateness_tree_t(size_t n) : size_{1} {
+            while (size_ < n) {
+                size_ *= 2;
+            }
+            max_.assign(2 * size_, std::numeric_limits<int>::min());
+            tardiness_.assign(2 * size_, 0);
+        }
+
+        void set(size_t pos, int lateness) {
+            size_t node = pos + size_;
+            max_[node] = lateness;
+            tardiness_[node] = std::max(0, lateness);
+            for (node /= 2; node >= 1; node /= 2) {
+                max_[node] = std::max(max_[2 * node], max_[2 * node + 1]);
+                tardiness_[node] = tardiness_[2 * node] + tardiness_[2 * node + 1];
+            }
+        }
+
+        int max() const {
+            return max_[1];
+        }
+
+        long long tardiness() const {
+            return tardiness_[1];
+        }
+
+        //! First position from begin on with a positive lateness, or the number of positions if there is none
+        size_t next_late(size_t begin) const {
+            if (begin >= size_) {
+                return size_;
+            }
+            // Up from the leaf of begin until a right sibling holds a late position, then down to the first one
+            size_t node = begin + size_;
+            if (max_[node] > 0) {
+                return begin;
+            }
+            while (node > 1 && (node % 2 == 1 || max_[node + 1] <= 0)) {
+                node /= 2;
+            }
+            if (node == 1) {
+                return size_;
+            }
+            for (++node; node < size_;) {
+                node = max_[2 * node] > 0 ? 2 * node : 2 * node + 1;
+            }
+            return node - size_;
+        }
+
+    private:
+        size_t size_;
+        std::vector<int> max_;
+        std::vector<long long> tardiness_;
+    };
+
+    // Perturbations are random but the same for every run
+    const unsigned KICK_SEED = 47;
+
+    // Positions a late job is moved back by at most in a perturbation, so that the moves after it can repair it
+    const size_t KICK_DISTANCE = 8;
+
+    class local_search_t {
+    public:
+        local_search_t(const problem_t &p, std::vector<int> order) : p_{p}, order_{std::move(order)},
+                                                                     completion_(order_.size()),
+                                                                     tree_{order_.size()} {
+            retime(0, order_.size());
+        }
+
+        /*!
+         * Improve the order until it meets the deadlines or no move improves it. With a time limit, the search then
+         * goes on from the local optimum: a random late job is moved to a random position of its block at most
+         * KICK_DISTANCE earlier, the late jobs from there on are swept once, and all of it is undone if the schedule got
+         * worse
+         * \return False if the time limit stopped the search first
+         */
+        bool run(const std::chrono::steady_clock::time_point *time_limit_end) {
+            time_limit_end_ = time_limit_end;
+            descend(0, true);
+            std::mt19937 rng{KICK_SEED};
+            while (time_limit_end_ && tree_.max() > 0 && !out_of_time()) {
+                const long long tardiness = tree_.tardiness();
+                const int max = tree_.max();
+                const long long moves = moves_;
+                size_t late = tree_.next_late(std::uniform_int_distribution<size_t>{0, order_.size() - 1}(rng));
+                if (late >= order_.size()) {
+                    late = tree_.next_late(0);
+                }
+                const size_t block = block_start(late);
+                if (block == late) {
+                    continue;
+                }
+                journal_.clear();
+                journaling_ = true;
+                const size_t earliest = late > block + KICK_DISTANCE ? late - KICK_DISTANCE : block;
+                move(late, std::uniform_int_distribution<size_t>{earliest, late - 1}(rng));
+                descend(block, false);
+                journaling_ = false;
+                if (tree_.tardiness() > tardiness || (tree_.tardiness() == tardiness && tree_.max() > max)) {
+                    for (auto it = journal_.rbegin(); it != journal_.rend(); ++it) {
+                        move(it->second, it->first);
+                    }
+                    moves_ = moves;
+                }
+            }
+            return !timed_out_;
+        }
+
+        const std::vector<int> &order() const {
+            return order_;
+        }
+
+        int max_lateness() const {
+            return tree_.max();
+        }
+
+        long long moves() const {
+            return moves_;
+        }
+
+    private:
+        const problem_t &p_;
+        std::vector<int> order_;
+        std::vector<int> completion_; // By position
+        lateness_tree_t tree_;
+        long long moves_ = 0;
+        const std::chrono::steady_clock::time_point *time_limit_end_ = nullptr;
+        bool timed_out_ = false;
+        // Moves {from, to} made since the last perturbation, to undo it
+        std::vector<std::pair<size_t, size_t>> journal_;
+        bool journaling_ = false;
+
+        /*!
+         * Sweep the late jobs from left to right, making an improving move for each one that has it. After a move, the
+         * sweep goes on from the block of the job, as positions before it did not change
+         * @param wrap Start over after the last late job until a whole sweep makes no move, otherwise stop there
+         */
+        void descend(size_t cursor, bool wrap) {
+            bool improved = false; // In the current sweep
+            while (tree_.max() > 0 && !timed_out_) {
+                const size_t late = tree_.next_late(cursor);
+                if (late >= order_.size()) {
+                    if (!wrap || !improved) {
+                        break;
+                    }
+                    improved = false;
+                    cursor = 0;
+                    continue;
+                }
+                const size_t block = block_start(late);
+                if (improve_job(late, block)) {
+                    improved = true;
+                    cursor = block;
+                } else {
+                    cursor = late + 1;
+                }
+            }
+        }
+
+        /*!
+         * Recompute the completion times after the jobs of positions [begin, end) changed. Past end, a position that
+         * completes at the same time as before leaves all the later ones as they were
+         */
+        void retime(size_t begin, size_t end) {
+            int c = begin == 0 ? 0 : completion_[begin - 1];
+            for (size_t i = begin; i < order_.size(); ++i) {
+                const int job = order_[i];
+                c = std::max(c, p_.r[job]) + p_.p[job];
+                if (i >= end && c == completion_[i]) {
+                    break;
+                }
+                completion_[i] = c;
+                tree_.set(i, c - p_.d[job]);
+            }
+        }
+
+        //! Move the job of position from to position to, shifting the jobs in between
+        void move(size_t from, size_t to) {
+            if (from < to) {
+                std::rotate(order_.begin() + from, order_.begin() + from + 1, order_.begin() + to + 1);
+            } else {
+                std::rotate(order_.begin() + to, order_.begin() + from, order_.begin() + from + 1);
+            }
+            retime(std::min(from, to), std::max(from, to) + 1);
+            if (journaling_) {
+                journal_.emplace_back(from, to);
+            }
+        }
+
+        //! Make the move, and undo it unless it lowers the total tardiness, or keeps it and lowers the maximum lateness
+        bool try_move(size_t from, size_t to) {
+            const long long tardiness = tree_.tardiness();
+            const int max = tree_.max();
+            move(from, to);
+            if (tree_.tardiness() < tardiness || (tree_.tardiness() == tardiness && tree_.max() < max)) {
+                ++moves_;
+                return true;
+            }
+            move(to, from);
+            if (journaling_) {
+                journal_.resize(journal_.size() - 2);
+            }
+            return false;
+        }
+
+        bool out_of_time() {
+            if (time_limit_end_ && std::chrono::steady_clock::now() >= *time_limit_end_) {
+                timed_out_ = true;
+            }
+            return timed_out_;
+        }
+
+        //! First position of the run of jobs without idle time up to pos, which starts with a job started at its release.
+        //! Jobs before it can not make the job at pos end earlier
+        size_t block_start(size_t pos) const {
+            while (pos > 0 && completion_[pos] - p_.p[order_[pos]] > p_.r[order_[pos]]) {
+                --pos;
+            }
+            return pos;
+        }
+
+        /*!
+         * Make one improving move in the block of the late job at the given position. A job of the block with a later
+         * deadline goes right after the late job or to its place by deadlines among the jobs after it, or the late job
+         * goes right before it
+         */
+        bool improve_job(size_t late, size_t block) {
+            const int deadline = p_.d[order_[late]];
+            int candidates = 0;
+            for (size_t i = late; i-- > block && candidates < MAX_CANDIDATES;) {
+                const int later_deadline = p_.d[order_[i]];
+                if (later_deadline <= deadline) {
+                    continue;
+                }
+                ++candidates;
+                if (out_of_time()) {
+                    return false;
+                }
+                size_t by_deadline = late + 1;
+                for (int scanned = 0; by_deadline < order_.size() && scanned < MAX_CANDIDATES &&
+                                      p_.d[order_[by_deadline]] <= later_deadline; ++by_deadline, ++scanned) {
+                }
+                if (try_move(i, late) || (by_deadline - 1 > late && try_move(i, by_deadline - 1)) ||
+                    try_move(late, i)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+}
+
+local_search_result_t local_search_schedule(const problem_t &p, double time_limit) {
+    TraceSpan span{"local_search"};
+    span.set_arg("n", p.n);
+    const auto end = std::chrono::steady_clock::now() +
+                     std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                             std::chrono::duration<double>(time_limit));
+    local_search_result_t res;
+    if (p.n == 0) {
+        return res;
+    }
+    res.lower_bound = objective_lower_bound(p, objective_t::MAX_LATENESS);
+    local_search_t search{p, schrage_order(p)};
+    // With the lower bound above 0 no order meets the deadlines, so there is nothing to search for
+    if (!res.proven_infeasible()) {
+        res.finished = search.run(time_limit > 0 ? &end : nullptr);
+    }
+    res.order = search.order();
+    res.max_lateness = search.max_lateness();
+    res.moves = search.moves();
+    span.set_arg("moves", res.moves);
+    span.set_arg("max_lateness", res.max_lateness);
+    span.set_arg("lower_bound", res.lower_bound);
+    return res;
+}
@@ -0,0 +1,52 @@
+#ifndef HW3_LOCAL_SEARCH_H
+#define HW3_LOCAL_SEARCH_H
+
+#include <vector>
+#include "problem.h"
+
+//! Seconds the automatic engine gets without --time-limit from this many jobs on. Smaller instances are solved exactly,
+//! however long it takes
+const double AUTO_TIME_LIMIT = 10;
+const int AUTO_TIME_LIMIT_MIN_N = 1000;
+
+//! Part of the time limit of the automatic engine for the local search. The branch-and-bound gets the rest
+const double AUTO_LOCAL_SEARCH_SHARE = 0.25;
+
+struct local_search_result_t {
+    //! Jobs in the order of execution of the best schedule found, even if it misses deadlines
+    std::vector<int> order;
+    //! Maximum lateness of the order, so it meets all the deadlines iff this is at most 0
+    int max_lateness = 0;
+    //! Maximum lateness of Jackson's preemptive schedule, above 0 proves that no schedule meets the deadlines
+    int lower_bound = 0;
+    //! Improving moves kept in the order
+    long long moves = 0;
+    //! False if the time limit stopped the search before it met the deadlines or, without perturbations, reached a
+    //! local optimum
+    bool finished = true;
+
+    bool meets_deadlines() const {
+        return max_lateness <= 0;
+    }
+
+    bool proven_infeasible() const {
+        return lower_bound > 0;
+    }
+};
+
+/*!
+ * Schedule for instances far too large for the exact engines. Schrage's heuristic gives the first order, which the local
+ * search then repairs, sweeping the late jobs from left to right. The block of a late job is the run of jobs without
+ * idle time before it, which starts with a job started at its release, and only moves within it can make the job end
+ * earlier: a job of the block with a later deadline goes right after the late job or to its place by deadlines after
+ * it, or the late job goes right before that job. A move is kept if it lowers the total tardiness, or keeps it and
+ * lowers the maximum lateness. Completion times are recomputed only from the first moved position until they agree
+ * with the old ones again, and the lateness is kept in a segment tree over positions, so a move costs O((k + t) log n)
+ * for k moved positions and t retimed ones after them. With a time limit, the search perturbs the local optimum and
+ * repairs it again until the deadlines are met or the time runs out
+ * @param time_limit Seconds after which the best schedule found so far is returned, 0 to stop at the first local
+ * optimum
+ */
+local_search_result_t local_search_schedule(const problem_t &p, double time_limit = 0);
+
+#endif //HW3_LOCAL_SEARCH_H
@@ -1,167 +1,149 @@
 #include <iostream>
-#include <vector>
-#include <fstream>
+#include <string>
 #include <algorithm>
-#include <set>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include "problem.h"
+#include "bratley.h"
+#include "subset_dp.h"
+#include "local_search.h"
+#include "trace.h"
 
-struct problem_t {
-    int n{};
-    std::vector<int> p;
-    std::vector<int> r;
-    std::vector<int> d;
-};
-
-problem_t read_input_from_file(const std::string &filename) {
-    problem_t p;
-    std::ifstream is{filename};
-    is >> p.n;
-    p.p.resize(p.n);
-    p.r.resize(p.n);
-    p.d.resize(p.n);
-    for (int i = 0; i < p.n; ++i) {
-        is >> p.p[i] >> p.r[i] >> p.d[i];
-    }
-    return p;
-}
-
-std::vector<int> get_visiting_order(const problem_t &p) {
-    // If all the release times are equal, the best nodes visiting order is by sorting them by deadlines, so abuse this here
-    std::vector<std::pair<int, int>> deadlines;
-    deadlines.reserve(p.n);
-    for (int i = 0; i < p.n; ++i) {
-        deadlines.emplace_back(p.d[i], i);
-    }
-    std::sort(deadlines.begin(), deadlines.end());
-    std::vector<int> res(p.n);
-    for (int i = 0; i < p.n; ++i) {
-        res[i] = deadlines[i].second;
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        std::cerr << "Error. Too few arguments" << std::endl;
+        return -1;
     }
-    return res;
-}
-
-namespace {
-    // Using global variables here. Not nice, but for such application let it be. Can replace with some state
-    // variable changed by each DFS iteration internally
-    std::vector<int> g_res;
-    std::vector<int> g_visiting_order;
-    std::vector<int> g_to_visit;
-
-}
-
-/*!
- * @param p problem
- * @param v current node
- * @param depth depth in the tree
- * @param visited array marking visited before nodes
- * @param c computation time of all the tasks before
- * @return pair {<solution found>, <solution can be found>}. If both are false, the algorithm should terminate as there is no possiblity to find the optimal solution anymore
- */
-std::pair<bool, bool> solve_scheduling_dfs(const problem_t &p, int v, int depth, std::vector<bool> &visited, int c) {
-    visited[v] = true;
-
-    if (std::max(c, p.r[v]) + p.p[v] > p.d[v]) {
-        visited[v] = false;
-        return {false, true};
+    std::string trace_filename;
+    int threads = 1;
+    bool minimize = false;
+    objective_t objective = objective_t::MAKESPAN;
+    double time_limit = 0;
+    std::string engine = "auto";
+    for (int i = 3; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_filename = argv[++i];
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            // 0 for all hardware threads
+            threads = std::stoi(argv[++i]);
+            if (threads <= 0) {
+                threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            }
+        } else if (std::strcmp(argv[i], "--minimize") == 0 && i + 1 < argc) {
+            // cmax for the makespan meeting the deadlines, lmax for the maximum lateness with deadlines as due dates
+            minimize = true;
+            ++i;
+            if (std::strcmp(argv[i], "cmax") == 0) {
+                objective = objective_t::MAKESPAN;
+            } else if (std::strcmp(argv[i], "lmax") == 0) {
+                objective = objective_t::MAX_LATENESS;
+            } else {
+                std::cerr << "Unknown objective: " << argv[i] << std::endl;
+                return -1;
+            }
+        } else if (std::strcmp(argv[i], "--time-limit") == 0 && i + 1 < argc) {
+            // Seconds, after which --minimize writes the best schedule found so far and the local search and the
+            // branch-and-bound after it give up
+            time_limit = std::stod(argv[++i]);
+        } else if (std::strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            // bnb for the branch-and-bound, dp for the subset DP, local for the local search only. auto for the DP up to
+            // SUBSET_DP_MAX_N jobs, otherwise the local search, falling back to the branch-and-bound when it finds no
+            // schedule meeting the deadlines and can not prove that there is none. Both share the time limit, which is
+            // AUTO_TIME_LIMIT from AUTO_TIME_LIMIT_MIN_N jobs on if not given
+            engine = argv[++i];
+            if (engine != "auto" && engine != "bnb" && engine != "dp" && engine != "local") {
+                std::cerr << "Unknown engine: " << engine << std::endl;
+                return -1;
+            }
+        } else {
+            std::cerr << "Unknown argument: " << argv[i] << std::endl;
+            return -1;
+        }
     }
-
-    // If reached a leaf, the solution is feasible. Return true and fill in the res array
-    if (depth == p.n) {
-        g_res[depth - 1] = v;
-        return {true, true};
+    if (!trace_filename.empty()) {
+        Tracer::instance().enable();
     }
 
-    int min_release_time = std::numeric_limits<int>::max();
-    int max_deadline = 0;
-    int total_work_left = 0;
-    for (int i = 0; i < p.n; ++i) {
-        if (!visited[i]) {
-            min_release_time = std::min(min_release_time, p.r[i]);
-            max_deadline = std::max(max_deadline, p.d[i]);
-            total_work_left += p.p[i];
-        }
+    if (minimize && threads > 1) {
+        std::cerr << "Warning: --minimize runs on a single thread" << std::endl;
     }
-
-    int c_new = std::max(c, p.r[v]) + p.p[v];
-    // Set if the first part of the solution is already optimal
-    bool already_optimal = false;
-    if (min_release_time >= c_new) {
-        already_optimal = true;
+    if (minimize && engine != "auto") {
+        std::cerr << "Warning: --minimize always uses the branch-and-bound" << std::endl;
     }
-
-
-    // If there is no possibility to find any feasible solution in this subtree, return false
-    if (std::max(c_new, min_release_time) + total_work_left > max_deadline) {
-        visited[v] = false;
-        return {false, ~already_optimal};
+    if (!minimize && time_limit > 0 && (engine == "bnb" || engine == "dp")) {
+        std::cerr << "Warning: --time-limit is used only with --minimize and the local search" << std::endl;
     }
 
-
-    for (int i = 0; i < p.n; ++i) {
-        int node = g_visiting_order[i];
-        if (visited[node])
-            continue;
-
-        auto dfs_res = solve_scheduling_dfs(p, node, depth + 1, visited, c_new);
-        if (dfs_res.first) {
-            g_res[depth - 1] = v;
-            visited[v] = false;
-            return {true, true};
+    // 2 if the search ran out of time without an answer
+    int status = 0;
+    auto p = read_input_from_file(argv[1]);
+    if (minimize) {
+        auto res = optimize_schedule(p, objective, time_limit);
+        if (!res.optimal) {
+            std::cerr << "Time limit reached, the schedule may not be optimal" << std::endl;
         }
-        if (!dfs_res.second) {
-            visited[v] = false;
-            return {false, false};
+        write_solution_to_file(p, res.order, argv[2]);
+    } else {
+        if (engine == "dp" && p.n > SUBSET_DP_LIMIT) {
+            std::cerr << "Warning: " << p.n << " jobs are too many for the subset DP, using the branch-and-bound"
+                      << std::endl;
+            engine = "bnb";
         }
-    }
-    visited[v] = false;
-    return {false, ~already_optimal};
-}
-
-
-std::vector<int> solve_scheduling(const problem_t &p) {
-    g_visiting_order = get_visiting_order(p);
-    g_res = std::vector<int>(p.n);
-    g_to_visit.reserve(p.n);
-    std::vector<bool> visited(p.n, false);
-    for (int i = 0; i < p.n; ++i) {
-        auto solver_res = solve_scheduling_dfs(p, i, 1, visited, 0);
-        if (solver_res.first) {
-            return g_res;
+        std::vector<int> solution;
+        // Set if the search gave up without a schedule or a proof that there is none
+        bool unknown = false;
+        if (engine == "dp" || (engine == "auto" && p.n <= SUBSET_DP_MAX_N)) {
+            solution = solve_subset_dp(p, threads);
+        } else if (engine == "bnb") {
+            solution = solve_scheduling(p, threads);
+        } else {
+            const auto start = std::chrono::steady_clock::now();
+            const bool fall_back = engine == "auto";
+            if (fall_back && time_limit == 0 && p.n >= AUTO_TIME_LIMIT_MIN_N) {
+                time_limit = AUTO_TIME_LIMIT;
+            }
+            auto res = local_search_schedule(p, fall_back ? time_limit * AUTO_LOCAL_SEARCH_SHARE : time_limit);
+            if (!fall_back) {
+                std::cerr << "Local search: maximum lateness " << res.max_lateness << ", lower bound "
+                          << res.lower_bound << ", " << res.moves << " moves" << std::endl;
+            }
+            if (res.meets_deadlines()) {
+                solution = res.order;
+                if (!fall_back) {
+                    std::cerr << "The schedule meets all the deadlines" << std::endl;
+                }
+            } else if (res.proven_infeasible()) {
+                if (!fall_back) {
+                    std::cerr << "No schedule meets all the deadlines" << std::endl;
+                }
+            } else if (fall_back) {
+                // Only the exact search may tell that no schedule meets the deadlines
+                const double left = time_limit - std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start).count();
+                bool finished = false;
+                if (time_limit == 0 || left > 0) {
+                    solution = solve_scheduling(p, threads, nullptr, time_limit == 0 ? 0 : left, &finished);
+                }
+                unknown = !finished;
+            } else {
+                unknown = true;
+            }
         }
-        if (!solver_res.second) {
-            return {};
+        if (unknown) {
+            // -1 would claim that no schedule exists, so there is no output rather than a wrong one
+            std::cerr << "No schedule meeting all the deadlines found, but one may exist. Nothing is written to "
+                      << argv[2] << std::endl;
+            std::remove(argv[2]);
+            status = 2;
+        } else {
+            write_solution_to_file(p, solution, argv[2]);
         }
     }
-    return {};
-}
 
-void write_solution_to_file(const problem_t &p, const std::vector<int> &sol, const std::string &output_filename) {
-    std::ofstream of{output_filename};
-    if (sol.empty()) {
-        of << -1 << std::endl;
-        return;
+    if (!trace_filename.empty() && !Tracer::instance().write_chrome_json(trace_filename)) {
+        std::cerr << "Could not write trace to " << trace_filename << std::endl;
     }
-
-    int c = 0;
-    std::vector<int> start_times{p.n};
-    for (int i = 0; i < p.n; ++i) {
-        int start_time = std::max(c, p.r[sol[i]]);
-        start_times[sol[i]] = start_time;
-        c += p.p[sol[i]];
-    }
-
-    for (int i = 0; i < p.n; ++i) {
-        of << start_times[i] << std::endl;
-    }
-}
-
-
-int main(int argc, char *argv[]) {
-    if (argc < 3) {
-        std::cerr << "Error. Too few arguments" << std::endl;
-        return -1;
-    }
-    auto p = read_input_from_file(argv[1]);
-    auto solution = solve_scheduling(p);
-    write_solution_to_file(p, solution, argv[2]);
-    return 0;
+    return status;
 }
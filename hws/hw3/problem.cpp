@@ -0,0 +1,61 @@
+#include "problem.h"
+#include <fstream>
+#include <algorithm>
+#include <limits>
+#include "trace.h"
+
+int objective_value(const problem_t &p, const std::vector<int> &order, objective_t objective) {
+    int c = 0;
+    int max_lateness = std::numeric_limits<int>::min();
+    for (int job: order) {
+        c = std::max(c, p.r[job]) + p.p[job];
+        max_lateness = std::max(max_lateness, c - p.d[job]);
+    }
+    return objective == objective_t::MAKESPAN ? c : max_lateness;
+}
+
+bool meets_deadlines(const problem_t &p, const std::vector<int> &order) {
+    int c = 0;
+    for (int job: order) {
+        c = std::max(c, p.r[job]) + p.p[job];
+        if (c > p.d[job]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+problem_t read_input_from_file(const std::string &filename) {
+    TraceSpan span{"read"};
+    problem_t p;
+    std::ifstream is{filename};
+    is >> p.n;
+    p.p.resize(p.n);
+    p.r.resize(p.n);
+    p.d.resize(p.n);
+    for (int i = 0; i < p.n; ++i) {
+        is >> p.p[i] >> p.r[i] >> p.d[i];
+    }
+    return p;
+}
+
+void write_solution_to_file(const problem_t &p, const std::vector<int> &sol, const std::string &output_filename) {
+    TraceSpan span{"write"};
+    std::ofstream of{output_filename};
+    if (sol.empty()) {
+        of << -1 << std::endl;
+        return;
+    }
+
+    int c = 0;
+    std::vector<int> start_times(p.n);
+    for (int i = 0; i < p.n; ++i) {
+        int start_time = std::max(c, p.r[sol[i]]);
+        start_times[sol[i]] = start_time;
+        c = start_time + p.p[sol[i]];
+    }
+
+    for (int i = 0; i < p.n; ++i) {
+        of << start_times[i] << std::endl;
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef HW3_PROBLEM_H
+#define HW3_PROBLEM_H
+
+#include <string>
+#include <vector>
+
+/*!
+ * Single machine scheduling instance: job i has processing time p[i], release time r[i] and deadline d[i]
+ */
+struct problem_t {
+    int n{};
+    std::vector<int> p;
+    std::vector<int> r;
+    std::vector<int> d;
+};
+
+//! What the optimization mode minimizes. For the maximum lateness, deadlines are due dates that may be missed
+enum class objective_t {
+    MAKESPAN,
+    MAX_LATENESS
+};
+
+/*!
+ * Makespan or maximum lateness of the jobs executed in the given order, each as soon as released
+ */
+int objective_value(const problem_t &p, const std::vector<int> &order, objective_t objective);
+
+//! True if the jobs executed in the given order meet all the deadlines
+bool meets_deadlines(const problem_t &p, const std::vector<int> &order);
+
+problem_t read_input_from_file(const std::string &filename);
+
+/*!
+ * Write start times of the jobs executed in the order given by sol, or -1 if sol is empty
+ */
+void write_solution_to_file(const problem_t &p, const std::vector<int> &sol, const std::string &output_filename);
+
+#endif //HW3_PROBLEM_H
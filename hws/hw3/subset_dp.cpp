@@ -0,0 +1,130 @@
+#include "subset_dp.h"
+#include <algorithm>
+#include <limits>
+#include <thread>
+#include "trace.h"
+
+namespace {
+    // Sets of a block share all but the lowest BLOCK_BITS bits. 16 ints are one cache line
+    const int BLOCK_BITS = 4;
+
+    // Completion time of sets that can not be scheduled. Adding a processing time to it can not overflow and the
+    // result is above any deadline
+    const int UNREACHABLE = std::numeric_limits<int>::max() / 2;
+
+    // Layers of fewer blocks are not worth starting threads for
+    const size_t MIN_BLOCKS_PER_THREAD = 1 << 10;
+
+    class subset_dp_t {
+    public:
+        explicit subset_dp_t(const problem_t &p) : p_{p}, block_bits_{std::min(p.n, BLOCK_BITS)},
+                                                   block_size_{size_t{1} << block_bits_},
+                                                   completion_(size_t{1} << p.n, UNREACHABLE) {}
+
+        void solve(int threads) {
+            // Blocks by the number of jobs of their higher bits
+            const int high_bits = p_.n - block_bits_;
+            std::vector<std::vector<size_t>> layers(high_bits + 1);
+            for (size_t block = 0; block < size_t{1} << high_bits; ++block) {
+                layers[__builtin_popcountll(block)].push_back(block);
+            }
+            for (const auto &layer: layers) {
+                const size_t workers = std::min<size_t>(std::max(1, threads),
+                                                        std::max<size_t>(1, layer.size() / MIN_BLOCKS_PER_THREAD));
+                if (workers <= 1) {
+                    solve_blocks(layer, 0, layer.size());
+                    continue;
+                }
+                std::vector<std::thread> pool;
+                const size_t chunk = (layer.size() + workers - 1) / workers;
+                for (size_t begin = 0; begin < layer.size(); begin += chunk) {
+                    pool.emplace_back(&subset_dp_t::solve_blocks, this, std::cref(layer), begin,
+                                      std::min(layer.size(), begin + chunk));
+                }
+                for (auto &t: pool) {
+                    t.join();
+                }
+            }
+        }
+
+        //! Jobs in the order of execution, empty if the set of all jobs is unreachable
+        std::vector<int> order() const {
+            std::vector<int> res;
+            size_t set = completion_.size() - 1;
+            if (completion_[set] == UNREACHABLE) {
+                return res;
+            }
+            // Walk back through the jobs that give the earliest completion of each set
+            while (set != 0) {
+                for (int j = 0; j < p_.n; ++j) {
+                    const size_t bit = size_t{1} << j;
+                    if ((set & bit) && add_job(completion_[set ^ bit], j) == completion_[set]) {
+                        res.push_back(j);
+                        set ^= bit;
+                        break;
+                    }
+                }
+            }
+            std::reverse(res.begin(), res.end());
+            return res;
+        }
+
+    private:
+        const problem_t &p_;
+        const int block_bits_;
+        const size_t block_size_;
+        std::vector<int> completion_;
+
+        // Completion of job j started after a set completed at c, or UNREACHABLE if it misses its deadline
+        int add_job(int c, int j) const {
+            const int end = std::max(c, p_.r[j]) + p_.p[j];
+            return end <= p_.d[j] ? end : UNREACHABLE;
+        }
+
+        void solve_blocks(const std::vector<size_t> &blocks, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                solve_block(blocks[i]);
+            }
+        }
+
+        void solve_block(size_t block) {
+            int *const sets = &completion_[block << block_bits_];
+            if (block == 0) {
+                sets[0] = 0;
+            }
+            // Jobs of the higher bits, from the blocks of a lower layer, element-wise over the block
+            for (int j = block_bits_; j < p_.n; ++j) {
+                if (!(block >> (j - block_bits_) & 1)) {
+                    continue;
+                }
+                const int *const from = &completion_[(block ^ size_t{1} << (j - block_bits_)) << block_bits_];
+                const int release = p_.r[j], processing = p_.p[j], deadline = p_.d[j];
+                for (size_t x = 0; x < block_size_; ++x) {
+                    const int c = std::max(from[x], release) + processing;
+                    sets[x] = std::min(sets[x], c <= deadline ? c : UNREACHABLE);
+                }
+            }
+            // Jobs of the lower bits, from sets of the same block, which are smaller so already final
+            for (size_t x = 1; x < block_size_; ++x) {
+                for (int j = 0; j < block_bits_; ++j) {
+                    if (x >> j & 1) {
+                        sets[x] = std::min(sets[x], add_job(sets[x ^ size_t{1} << j], j));
+                    }
+                }
+            }
+        }
+    };
+}
+
+std::vector<int> solve_subset_dp(const problem_t &p, int threads) {
+    TraceSpan span{"subset_dp"};
+    span.set_arg("n", p.n);
+    if (p.n > SUBSET_DP_LIMIT) {
+        return {};
+    }
+    subset_dp_t dp{p};
+    dp.solve(threads);
+    auto res = dp.order();
+    span.set_arg("feasible", !res.empty());
+    return res;
+}
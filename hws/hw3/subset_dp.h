@@ -0,0 +1,27 @@
+#ifndef HW3_SUBSET_DP_H
+#define HW3_SUBSET_DP_H
+
+#include <vector>
+#include "problem.h"
+
+//! Instances up to this size are solved by the subset DP when the engine is chosen automatically. Beyond it, the DP
+//! gets slower than the branch-and-bound on all but the adversarial instances, as its table of 2^n ints is always filled
+const int SUBSET_DP_MAX_N = 16;
+
+//! Larger instances are refused by the subset DP, as its table would not fit into memory
+const int SUBSET_DP_LIMIT = 28;
+
+/*!
+ * Find a schedule respecting release times and deadlines by dynamic programming over the sets of scheduled jobs. The
+ * earliest completion time of a set S is the minimum over its jobs j of max(C(S \ j), r_j) + p_j among those meeting
+ * d_j, which takes O(2^n n) time no matter how adversarial the instance is.
+ * Sets are processed in blocks of consecutive sets that differ only in the lowest bits. Removing a job of a higher bit
+ * maps a block onto another whole block, so these transitions are element-wise over the block and vectorize. Blocks
+ * with the same number of higher bits do not depend on each other, so with more threads each such layer is split
+ * among them
+ * @param threads Number of threads working on a layer
+ * @return Jobs in the order of execution, or an empty vector if no feasible schedule exists or n > SUBSET_DP_LIMIT
+ */
+std::vector<int> solve_subset_dp(const problem_t &p, int threads = 1);
+
+#endif //HW3_SUBSET_DP_H